@@ -0,0 +1,81 @@
+#include <GL/glew.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "TraceReader.h"
+#include "Replayer.h"
+#include "ReplayContext.h"
+
+// 无窗口回放 GL 调用追踪，统计 CPU 开销
+// 用法：GLReplay <trace> [--loops N] [--finish] [--software] [--no-call-timing] [--headless]
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: GLReplay <trace> [--loops N] [--finish] [--software] [--no-call-timing] [--headless]" << std::endl;
+        return -1;
+    }
+
+    std::string tracePath = argv[1];
+    ReplayOptions options;
+    bool software = false;
+    bool allowWindow = true;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--loops" && i + 1 < argc)
+            options.Loops = (unsigned int)std::atoi(argv[++i]);
+        else if (arg == "--finish")
+            options.FinishEachFrame = true;
+        else if (arg == "--software")
+            software = true;
+        else if (arg == "--no-call-timing")
+            options.PerCallTiming = false;
+        else if (arg == "--headless")
+            allowWindow = false;
+    }
+
+    // 强制使用 Mesa 的 llvmpipe 软件光栅化（Windows 上需要把 Mesa 的 opengl32.dll 放在程序旁边）
+    if (software)
+    {
+#ifdef PLATFORM_WINDOWS
+        _putenv("GALLIUM_DRIVER=llvmpipe");
+        _putenv("LIBGL_ALWAYS_SOFTWARE=1");
+#else
+        setenv("GALLIUM_DRIVER", "llvmpipe", 1);
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+#endif
+    }
+
+    TraceReader trace;
+    if (!trace.Load(tracePath))
+        return -1;
+    std::cout << "Loaded " << trace.GetCalls().size() << " calls, " << trace.GetFrameCount() << " frames";
+    if (trace.GetUnknownCalls() > 0)
+        std::cout << " (" << trace.GetUnknownCalls() << " calls of unknown functions skipped)";
+    std::cout << std::endl;
+
+    // 优先使用不需要显示服务器的 EGL pbuffer，--headless 时不退回隐藏窗口
+    ReplayContext context;
+    if (!context.Create(640, 480, allowWindow))
+        return -1;
+
+    // EGL 上下文没有 GLX 显示，glewInit 在加载完 GL 函数之后才报这个错误，可以忽略
+    GLenum glewResult = glewInit();
+    if (glewResult != GLEW_OK && !(glewResult == GLEW_ERROR_NO_GLX_DISPLAY && context.IsHeadless()))
+    {
+        std::cout << "Error initializing GLEW" << std::endl;
+        return -1;
+    }
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << " / " << glGetString(GL_VERSION)
+        << " (" << context.GetBackend() << ")" << std::endl;
+
+    {
+        Replayer replayer(trace, options);
+        replayer.Run();
+        replayer.PrintReport();
+    }
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "ReplayContext.h"
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <iostream>
+
+#ifndef PLATFORM_WINDOWS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+ReplayContext::ReplayContext() : m_Window(nullptr)
+#ifndef PLATFORM_WINDOWS
+    , m_Display(nullptr), m_Surface(nullptr), m_Context(nullptr)
+#endif
+{
+}
+
+ReplayContext::~ReplayContext()
+{
+    Destroy();
+}
+
+bool ReplayContext::Create(int width, int height, bool allowWindow)
+{
+    if (CreateHeadless(width, height))
+        return true;
+    if (!allowWindow)
+    {
+        std::cout << "No headless GL context available" << std::endl;
+        return false;
+    }
+    return CreateHiddenWindow(width, height);
+}
+
+const char* ReplayContext::GetBackend() const
+{
+    return m_Window ? "GLFW hidden window" : "EGL pbuffer";
+}
+
+bool ReplayContext::CreateHiddenWindow(int width, int height)
+{
+    if (!glfwInit())
+        return false;
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(width, height, "GLReplay", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    m_Window = window;
+    return true;
+}
+
+#ifdef PLATFORM_WINDOWS
+bool ReplayContext::CreateHeadless(int, int)
+{
+    return false;
+}
+
+void ReplayContext::Destroy()
+{
+    if (!m_Window)
+        return;
+    glfwDestroyWindow((GLFWwindow*)m_Window);
+    glfwTerminate();
+    m_Window = nullptr;
+}
+#else
+namespace
+{
+    // Mesa 的 surfaceless 平台完全不接触窗口系统；没有这个扩展时用默认显示
+    EGLDisplay OpenDisplay()
+    {
+        const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (extensions && std::strstr(extensions, "EGL_MESA_platform_surfaceless"))
+        {
+            auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+            if (getPlatformDisplay)
+            {
+                EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+                    return display;
+            }
+        }
+        EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+            return display;
+        return EGL_NO_DISPLAY;
+    }
+}
+
+bool ReplayContext::CreateHeadless(int width, int height)
+{
+    EGLDisplay display = OpenDisplay();
+    if (display == EGL_NO_DISPLAY)
+        return false;
+    m_Display = display;
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint count = 0;
+    if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttribs, &config, 1, &count) || count == 0)
+    {
+        Destroy();
+        return false;
+    }
+
+    // 默认帧缓冲就是这个 pbuffer，与录制时的窗口大小无关
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    m_Surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+    if (m_Surface == EGL_NO_SURFACE)
+    {
+        m_Surface = nullptr;
+        Destroy();
+        return false;
+    }
+
+    // 依次尝试较新的核心模式，都失败时用驱动默认的版本
+    const EGLint versions[][2] = { { 4, 6 }, { 4, 5 }, { 3, 3 } };
+    for (const EGLint* version : versions)
+    {
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version[0], EGL_CONTEXT_MINOR_VERSION, version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        m_Context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (m_Context != EGL_NO_CONTEXT)
+            break;
+    }
+    if (m_Context == EGL_NO_CONTEXT)
+        m_Context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    if (m_Context == EGL_NO_CONTEXT || !eglMakeCurrent(display, m_Surface, m_Surface, m_Context))
+    {
+        if (m_Context == EGL_NO_CONTEXT)
+            m_Context = nullptr;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void ReplayContext::Destroy()
+{
+    if (m_Window)
+    {
+        glfwDestroyWindow((GLFWwindow*)m_Window);
+        glfwTerminate();
+        m_Window = nullptr;
+    }
+    if (m_Display)
+    {
+        eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_Context)
+            eglDestroyContext(m_Display, m_Context);
+        if (m_Surface)
+            eglDestroySurface(m_Display, m_Surface);
+        eglTerminate(m_Display);
+        m_Display = nullptr;
+        m_Surface = nullptr;
+        m_Context = nullptr;
+    }
+}
+#endif
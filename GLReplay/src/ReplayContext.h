@@ -0,0 +1,31 @@
+#pragma once
+
+// 回放用的 GL 上下文，所有绘制都在离屏的默认帧缓冲上。
+// Linux 上优先用 EGL pbuffer，不需要显示服务器（渲染节点、CI 机器）；EGL 不可用时退回 GLFW 隐藏窗口。
+// Windows 上没有 EGL，总是使用隐藏窗口
+class ReplayContext
+{
+private:
+    void* m_Window;     // GLFWwindow
+#ifndef PLATFORM_WINDOWS
+    void* m_Display;    // EGLDisplay
+    void* m_Surface;    // EGLSurface
+    void* m_Context;    // EGLContext
+#endif
+public:
+    ReplayContext();
+    ~ReplayContext();
+
+    ReplayContext(const ReplayContext&) = delete;
+    ReplayContext& operator=(const ReplayContext&) = delete;
+
+    // allowWindow 为 false 时只尝试无窗口的方式
+    bool Create(int width, int height, bool allowWindow);
+    void Destroy();
+
+    inline bool IsHeadless() const { return m_Window == nullptr; }
+    const char* GetBackend() const;
+private:
+    bool CreateHeadless(int width, int height);
+    bool CreateHiddenWindow(int width, int height);
+};
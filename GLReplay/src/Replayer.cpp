@@ -0,0 +1,508 @@
+#include "Replayer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    inline GLint I(const TraceCall& call, int i) { return (GLint)(int64_t)call.Args[i]; }
+    inline GLuint U(const TraceCall& call, int i) { return (GLuint)call.Args[i]; }
+    inline GLenum E(const TraceCall& call, int i) { return (GLenum)call.Args[i]; }
+
+    inline float F(const TraceCall& call, int i)
+    {
+        uint32_t bits = (uint32_t)call.Args[i];
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    inline const void* P(const TraceCall& call, int i) { return (const void*)(uintptr_t)call.Args[i]; }
+
+    GLuint Lookup(const std::unordered_map<uint64_t, GLuint>& names, uint64_t name)
+    {
+        if (name == 0)
+            return 0;
+        auto it = names.find(name);
+        return it != names.end() ? it->second : 0;
+    }
+
+    // glGen*/glDelete*：参数为 n 和录制到的名字；名字太多时第二个参数是 GLuint 数组 blob 的哈希
+    std::vector<uint64_t> RecordedNames(const TraceReader& trace, const TraceCall& call)
+    {
+        std::vector<uint64_t> names;
+        if (call.HashMask & 2)
+        {
+            if (const std::string* blob = trace.GetBlob(call.Args[1]))
+            {
+                names.resize(blob->size() / sizeof(GLuint));
+                for (size_t i = 0; i < names.size(); i++)
+                {
+                    GLuint name;
+                    std::memcpy(&name, blob->data() + i * sizeof(GLuint), sizeof(name));
+                    names[i] = name;
+                }
+            }
+            return names;
+        }
+        names.assign(call.Args + 1, call.Args + call.ArgCount);
+        return names;
+    }
+
+    template<typename Gen>
+    void GenNames(const TraceReader& trace, const TraceCall& call, std::unordered_map<uint64_t, GLuint>& names, Gen gen)
+    {
+        GLsizei n = I(call, 0);
+        std::vector<GLuint> created(n);
+        gen(n, created.data());
+        std::vector<uint64_t> recorded = RecordedNames(trace, call);
+        for (size_t i = 0; i < (size_t)n && i < recorded.size(); i++)
+            names[recorded[i]] = created[i];
+    }
+
+    template<typename Delete>
+    void DeleteNames(const TraceReader& trace, const TraceCall& call, std::unordered_map<uint64_t, GLuint>& names, Delete del)
+    {
+        std::vector<GLuint> deleted;
+        for (uint64_t name : RecordedNames(trace, call))
+        {
+            auto it = names.find(name);
+            if (it == names.end())
+                continue;
+            deleted.push_back(it->second);
+            names.erase(it);
+        }
+        if (!deleted.empty())
+            del((GLsizei)deleted.size(), deleted.data());
+    }
+
+    // 不需要显式刷新的写映射在映射时整段写入零数据，代替应用写入的内容；
+    // 持久映射的写入对录制端不可见，不做处理
+    char* FillMapped(void* memory, GLbitfield access, size_t length)
+    {
+        if (memory && (access & GL_MAP_WRITE_BIT) && !(access & (GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_PERSISTENT_BIT)))
+            std::memset(memory, 0, length);
+        return (char*)memory;
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    inline uint64_t ElapsedNs(Clock::time_point start, Clock::time_point end)
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+}
+
+Replayer::Replayer(const TraceReader& trace, const ReplayOptions& options)
+    : m_Trace(trace), m_Options(options), m_CurrentProgram(0), m_TotalCalls(0), m_TotalSeconds(0.0)
+{
+    m_FuncStats.resize((size_t)GLTraceFunc::Count);
+}
+
+void Replayer::Run()
+{
+    const auto& calls = m_Trace.GetCalls();
+    auto runStart = Clock::now();
+
+    for (unsigned int loop = 0; loop < m_Options.Loops; loop++)
+    {
+        auto frameStart = Clock::now();
+        for (const TraceCall& call : calls)
+        {
+            FuncStats& stats = m_FuncStats[(size_t)call.Func];
+            if (m_Options.PerCallTiming)
+            {
+                auto start = Clock::now();
+                Execute(call);
+                stats.TotalNs += ElapsedNs(start, Clock::now());
+            }
+            else
+            {
+                Execute(call);
+            }
+            stats.Count++;
+            stats.RecordedNs += call.DurationNs;
+            m_TotalCalls++;
+
+            if (call.Func == GLTraceFunc::FrameEnd)
+            {
+                if (m_Options.FinishEachFrame)
+                    glFinish();
+                auto frameEnd = Clock::now();
+                m_FrameTimesMs.push_back(ElapsedNs(frameStart, frameEnd) / 1e6);
+                frameStart = frameEnd;
+            }
+        }
+        // 每轮结束后释放本轮创建的对象，下一轮从同样的初始状态开始
+        ReleaseObjects();
+    }
+
+    glFinish();
+    m_TotalSeconds = ElapsedNs(runStart, Clock::now()) / 1e9;
+}
+
+void Replayer::Execute(const TraceCall& call)
+{
+    switch (call.Func)
+    {
+    case GLTraceFunc::FrameEnd:
+        break;
+    case GLTraceFunc::Clear:
+        glClear(U(call, 0));
+        break;
+    case GLTraceFunc::ClearColor:
+        glClearColor(F(call, 0), F(call, 1), F(call, 2), F(call, 3));
+        break;
+    case GLTraceFunc::Viewport:
+        glViewport(I(call, 0), I(call, 1), I(call, 2), I(call, 3));
+        break;
+    case GLTraceFunc::Enable:
+        glEnable(E(call, 0));
+        break;
+    case GLTraceFunc::Disable:
+        glDisable(E(call, 0));
+        break;
+    case GLTraceFunc::BlendFunc:
+        glBlendFunc(E(call, 0), E(call, 1));
+        break;
+    case GLTraceFunc::DepthFunc:
+        glDepthFunc(E(call, 0));
+        break;
+
+    case GLTraceFunc::GenBuffers:
+        GenNames(m_Trace, call, m_Buffers, [](GLsizei n, GLuint* names) { glGenBuffers(n, names); });
+        break;
+    case GLTraceFunc::DeleteBuffers:
+        // 删除会解除映射，录制时的名字之后可能被重新使用
+        for (uint64_t name : RecordedNames(m_Trace, call))
+            m_MappedBuffers.erase(name);
+        DeleteNames(m_Trace, call, m_Buffers, [](GLsizei n, const GLuint* names) { glDeleteBuffers(n, names); });
+        break;
+    case GLTraceFunc::BindBuffer:
+        glBindBuffer(E(call, 0), Lookup(m_Buffers, call.Args[1]));
+        break;
+    case GLTraceFunc::BufferData:
+        // 只录制了内容的哈希，用同样大小的零数据代替
+        glBufferData(E(call, 0), (GLsizeiptr)call.Args[1], call.Args[2] ? Scratch((size_t)call.Args[1]) : nullptr, E(call, 3));
+        break;
+    case GLTraceFunc::BufferSubData:
+        glBufferSubData(E(call, 0), (GLintptr)call.Args[1], (GLsizeiptr)call.Args[2], Scratch((size_t)call.Args[2]));
+        break;
+
+    case GLTraceFunc::GenVertexArrays:
+        GenNames(m_Trace, call, m_VertexArrays, [](GLsizei n, GLuint* names) { glGenVertexArrays(n, names); });
+        break;
+    case GLTraceFunc::DeleteVertexArrays:
+        DeleteNames(m_Trace, call, m_VertexArrays, [](GLsizei n, const GLuint* names) { glDeleteVertexArrays(n, names); });
+        break;
+    case GLTraceFunc::BindVertexArray:
+        glBindVertexArray(Lookup(m_VertexArrays, call.Args[0]));
+        break;
+    case GLTraceFunc::EnableVertexAttribArray:
+        glEnableVertexAttribArray(U(call, 0));
+        break;
+    case GLTraceFunc::VertexAttribPointer:
+        glVertexAttribPointer(U(call, 0), I(call, 1), E(call, 2), (GLboolean)call.Args[3], I(call, 4), P(call, 5));
+        break;
+
+    case GLTraceFunc::CreateShader:
+        m_Shaders[call.Args[1]] = glCreateShader(E(call, 0));
+        break;
+    case GLTraceFunc::ShaderSource:
+        if (const std::string* source = m_Trace.GetBlob(call.Args[1]))
+        {
+            const char* src = source->c_str();
+            GLint length = (GLint)source->size();
+            glShaderSource(Lookup(m_Shaders, call.Args[0]), 1, &src, &length);
+        }
+        break;
+    case GLTraceFunc::CompileShader:
+        glCompileShader(Lookup(m_Shaders, call.Args[0]));
+        break;
+    case GLTraceFunc::DeleteShader:
+        glDeleteShader(Lookup(m_Shaders, call.Args[0]));
+        m_Shaders.erase(call.Args[0]);
+        break;
+    case GLTraceFunc::CreateProgram:
+        m_Programs[call.Args[0]] = glCreateProgram();
+        break;
+    case GLTraceFunc::AttachShader:
+        glAttachShader(Lookup(m_Programs, call.Args[0]), Lookup(m_Shaders, call.Args[1]));
+        break;
+    case GLTraceFunc::LinkProgram:
+        glLinkProgram(Lookup(m_Programs, call.Args[0]));
+        break;
+    case GLTraceFunc::ValidateProgram:
+        glValidateProgram(Lookup(m_Programs, call.Args[0]));
+        break;
+    case GLTraceFunc::DeleteProgram:
+        glDeleteProgram(Lookup(m_Programs, call.Args[0]));
+        m_Programs.erase(call.Args[0]);
+        break;
+    case GLTraceFunc::UseProgram:
+        m_CurrentProgram = call.Args[0];
+        glUseProgram(Lookup(m_Programs, call.Args[0]));
+        break;
+
+    case GLTraceFunc::GetUniformLocation:
+        if (const std::string* name = m_Trace.GetBlob(call.Args[1]))
+        {
+            GLint location = glGetUniformLocation(Lookup(m_Programs, call.Args[0]), name->c_str());
+            m_UniformLocations[(call.Args[0] << 32) ^ (uint32_t)I(call, 2)] = location;
+        }
+        break;
+    case GLTraceFunc::Uniform1i:
+        glUniform1i(MapLocation(call.Args[0]), I(call, 1));
+        break;
+    case GLTraceFunc::Uniform1f:
+        glUniform1f(MapLocation(call.Args[0]), F(call, 1));
+        break;
+    case GLTraceFunc::Uniform4f:
+        glUniform4f(MapLocation(call.Args[0]), F(call, 1), F(call, 2), F(call, 3), F(call, 4));
+        break;
+    case GLTraceFunc::UniformMatrix4fv:
+        glUniformMatrix4fv(MapLocation(call.Args[0]), I(call, 1), (GLboolean)call.Args[2],
+            (const GLfloat*)Scratch(I(call, 1) * 16 * sizeof(GLfloat)));
+        break;
+
+    case GLTraceFunc::GenTextures:
+        GenNames(m_Trace, call, m_Textures, [](GLsizei n, GLuint* names) { glGenTextures(n, names); });
+        break;
+    case GLTraceFunc::DeleteTextures:
+        DeleteNames(m_Trace, call, m_Textures, [](GLsizei n, const GLuint* names) { glDeleteTextures(n, names); });
+        break;
+    case GLTraceFunc::BindTexture:
+        glBindTexture(E(call, 0), Lookup(m_Textures, call.Args[1]));
+        break;
+    case GLTraceFunc::ActiveTexture:
+        glActiveTexture(E(call, 0));
+        break;
+
+    case GLTraceFunc::DrawArrays:
+        glDrawArrays(E(call, 0), I(call, 1), I(call, 2));
+        break;
+    case GLTraceFunc::DrawElements:
+        glDrawElements(E(call, 0), I(call, 1), E(call, 2), P(call, 3));
+        break;
+    case GLTraceFunc::VertexAttribDivisor:
+        glVertexAttribDivisor(U(call, 0), U(call, 1));
+        break;
+    case GLTraceFunc::DrawElementsInstanced:
+        glDrawElementsInstanced(E(call, 0), I(call, 1), E(call, 2), P(call, 3), I(call, 4));
+        break;
+    case GLTraceFunc::DrawElementsBaseVertex:
+        glDrawElementsBaseVertex(E(call, 0), I(call, 1), E(call, 2), (void*)P(call, 3), I(call, 4));
+        break;
+    case GLTraceFunc::DrawElementsInstancedBaseVertex:
+        glDrawElementsInstancedBaseVertex(E(call, 0), I(call, 1), E(call, 2), P(call, 3), I(call, 4), I(call, 5));
+        break;
+
+    case GLTraceFunc::BufferStorage:
+        glBufferStorage(E(call, 0), (GLsizeiptr)call.Args[1], call.Args[2] ? Scratch((size_t)call.Args[1]) : nullptr, U(call, 3));
+        break;
+    case GLTraceFunc::MapBufferRange:
+    {
+        void* memory = glMapBufferRange(E(call, 0), (GLintptr)call.Args[1], (GLsizeiptr)call.Args[2], U(call, 3));
+        m_MappedTargets[E(call, 0)] = FillMapped(memory, U(call, 3), (size_t)call.Args[2]);
+        break;
+    }
+    case GLTraceFunc::FlushMappedBufferRange:
+    {
+        auto it = m_MappedTargets.find(E(call, 0));
+        if (it != m_MappedTargets.end() && it->second)
+            std::memset(it->second + call.Args[1], 0, (size_t)call.Args[2]);
+        glFlushMappedBufferRange(E(call, 0), (GLintptr)call.Args[1], (GLsizeiptr)call.Args[2]);
+        break;
+    }
+    case GLTraceFunc::UnmapBuffer:
+        glUnmapBuffer(E(call, 0));
+        m_MappedTargets.erase(E(call, 0));
+        break;
+
+    case GLTraceFunc::FenceSync:
+        m_Syncs[call.Args[2]] = glFenceSync(E(call, 0), U(call, 1));
+        break;
+    case GLTraceFunc::ClientWaitSync:
+    {
+        auto it = m_Syncs.find(call.Args[0]);
+        if (it != m_Syncs.end())
+            glClientWaitSync(it->second, U(call, 1), call.Args[2]);
+        break;
+    }
+    case GLTraceFunc::DeleteSync:
+    {
+        auto it = m_Syncs.find(call.Args[0]);
+        if (it != m_Syncs.end())
+        {
+            glDeleteSync(it->second);
+            m_Syncs.erase(it);
+        }
+        break;
+    }
+
+    case GLTraceFunc::TexImage2D:
+        // 第 6 个参数是录制时像素数据的字节数，border 固定为 0
+        glTexImage2D(E(call, 0), I(call, 1), I(call, 2), I(call, 3), I(call, 4), 0, E(call, 6), E(call, 7),
+            call.Args[5] ? Scratch((size_t)call.Args[5]) : nullptr);
+        break;
+    case GLTraceFunc::TexParameteri:
+        glTexParameteri(E(call, 0), E(call, 1), I(call, 2));
+        break;
+
+    case GLTraceFunc::CreateBuffers:
+        GenNames(m_Trace, call, m_Buffers, [](GLsizei n, GLuint* names) { glCreateBuffers(n, names); });
+        break;
+    case GLTraceFunc::NamedBufferData:
+        glNamedBufferData(Lookup(m_Buffers, call.Args[0]), (GLsizeiptr)call.Args[1], call.Args[2] ? Scratch((size_t)call.Args[1]) : nullptr, E(call, 3));
+        break;
+    case GLTraceFunc::NamedBufferSubData:
+        glNamedBufferSubData(Lookup(m_Buffers, call.Args[0]), (GLintptr)call.Args[1], (GLsizeiptr)call.Args[2], Scratch((size_t)call.Args[2]));
+        break;
+    case GLTraceFunc::NamedBufferStorage:
+        glNamedBufferStorage(Lookup(m_Buffers, call.Args[0]), (GLsizeiptr)call.Args[1], call.Args[2] ? Scratch((size_t)call.Args[1]) : nullptr, U(call, 3));
+        break;
+
+    case GLTraceFunc::CreateVertexArrays:
+        GenNames(m_Trace, call, m_VertexArrays, [](GLsizei n, GLuint* names) { glCreateVertexArrays(n, names); });
+        break;
+    case GLTraceFunc::EnableVertexArrayAttrib:
+        glEnableVertexArrayAttrib(Lookup(m_VertexArrays, call.Args[0]), U(call, 1));
+        break;
+    case GLTraceFunc::VertexArrayAttribFormat:
+        glVertexArrayAttribFormat(Lookup(m_VertexArrays, call.Args[0]), U(call, 1), I(call, 2), E(call, 3), (GLboolean)call.Args[4], U(call, 5));
+        break;
+    case GLTraceFunc::VertexArrayAttribBinding:
+        glVertexArrayAttribBinding(Lookup(m_VertexArrays, call.Args[0]), U(call, 1), U(call, 2));
+        break;
+    case GLTraceFunc::VertexArrayVertexBuffer:
+        glVertexArrayVertexBuffer(Lookup(m_VertexArrays, call.Args[0]), U(call, 1), Lookup(m_Buffers, call.Args[2]), (GLintptr)call.Args[3], I(call, 4));
+        break;
+    case GLTraceFunc::VertexArrayBindingDivisor:
+        glVertexArrayBindingDivisor(Lookup(m_VertexArrays, call.Args[0]), U(call, 1), U(call, 2));
+        break;
+    case GLTraceFunc::BindVertexBuffer:
+        glBindVertexBuffer(U(call, 0), Lookup(m_Buffers, call.Args[1]), (GLintptr)call.Args[2], I(call, 3));
+        break;
+    case GLTraceFunc::VertexAttribFormat:
+        glVertexAttribFormat(U(call, 0), I(call, 1), E(call, 2), (GLboolean)call.Args[3], U(call, 4));
+        break;
+    case GLTraceFunc::VertexAttribBinding:
+        glVertexAttribBinding(U(call, 0), U(call, 1));
+        break;
+    case GLTraceFunc::VertexBindingDivisor:
+        glVertexBindingDivisor(U(call, 0), U(call, 1));
+        break;
+
+    case GLTraceFunc::MapNamedBufferRange:
+    {
+        void* memory = glMapNamedBufferRange(Lookup(m_Buffers, call.Args[0]), (GLintptr)call.Args[1], (GLsizeiptr)call.Args[2], U(call, 3));
+        m_MappedBuffers[call.Args[0]] = FillMapped(memory, U(call, 3), (size_t)call.Args[2]);
+        break;
+    }
+    case GLTraceFunc::FlushMappedNamedBufferRange:
+    {
+        auto it = m_MappedBuffers.find(call.Args[0]);
+        if (it != m_MappedBuffers.end() && it->second)
+            std::memset(it->second + call.Args[1], 0, (size_t)call.Args[2]);
+        glFlushMappedNamedBufferRange(Lookup(m_Buffers, call.Args[0]), (GLintptr)call.Args[1], (GLsizeiptr)call.Args[2]);
+        break;
+    }
+    case GLTraceFunc::UnmapNamedBuffer:
+        glUnmapNamedBuffer(Lookup(m_Buffers, call.Args[0]));
+        m_MappedBuffers.erase(call.Args[0]);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void Replayer::ReleaseObjects()
+{
+    glUseProgram(0);
+    glBindVertexArray(0);
+    for (auto& sync : m_Syncs)
+        glDeleteSync(sync.second);
+    // 删除缓冲区时驱动会解除映射
+    for (auto& buffer : m_Buffers)
+        glDeleteBuffers(1, &buffer.second);
+    for (auto& vertexArray : m_VertexArrays)
+        glDeleteVertexArrays(1, &vertexArray.second);
+    for (auto& texture : m_Textures)
+        glDeleteTextures(1, &texture.second);
+    for (auto& shader : m_Shaders)
+        glDeleteShader(shader.second);
+    for (auto& program : m_Programs)
+        glDeleteProgram(program.second);
+    m_Buffers.clear();
+    m_VertexArrays.clear();
+    m_Textures.clear();
+    m_Shaders.clear();
+    m_Programs.clear();
+    m_UniformLocations.clear();
+    m_Syncs.clear();
+    m_MappedTargets.clear();
+    m_MappedBuffers.clear();
+    m_CurrentProgram = 0;
+}
+
+const void* Replayer::Scratch(size_t size)
+{
+    if (m_Scratch.size() < size)
+        m_Scratch.resize(size, 0);
+    return m_Scratch.data();
+}
+
+GLint Replayer::MapLocation(uint64_t location) const
+{
+    auto it = m_UniformLocations.find((m_CurrentProgram << 32) ^ (uint32_t)location);
+    return it != m_UniformLocations.end() ? it->second : -1;
+}
+
+void Replayer::PrintReport() const
+{
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Replayed " << m_TotalCalls << " calls in " << m_TotalSeconds << " s ("
+        << (m_TotalSeconds > 0.0 ? m_TotalCalls / m_TotalSeconds : 0.0) << " calls/s)" << std::endl;
+
+    if (!m_FrameTimesMs.empty())
+    {
+        std::vector<double> sorted = m_FrameTimesMs;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double t : sorted)
+            sum += t;
+        std::cout << "Frames: " << sorted.size()
+            << "  min " << sorted.front() << " ms"
+            << "  avg " << sum / sorted.size() << " ms"
+            << "  p50 " << sorted[sorted.size() / 2] << " ms"
+            << "  p95 " << sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)] << " ms"
+            << "  max " << sorted.back() << " ms" << std::endl;
+    }
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < m_FuncStats.size(); i++)
+    {
+        if (m_FuncStats[i].Count > 0)
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b)
+    {
+        return m_FuncStats[a].TotalNs > m_FuncStats[b].TotalNs;
+    });
+
+    std::cout << std::left << std::setw(26) << "Function" << std::right
+        << std::setw(12) << "Calls" << std::setw(14) << "Total ms"
+        << std::setw(12) << "Avg ns" << std::setw(14) << "Recorded ns" << std::endl;
+    for (size_t i : order)
+    {
+        const FuncStats& stats = m_FuncStats[i];
+        std::cout << std::left << std::setw(26) << GLTraceFuncName((GLTraceFunc)i) << std::right
+            << std::setw(12) << stats.Count
+            << std::setw(14) << stats.TotalNs / 1e6
+            << std::setw(12) << (double)stats.TotalNs / stats.Count
+            << std::setw(14) << (double)stats.RecordedNs / stats.Count << std::endl;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <unordered_map>
+#include <vector>
+#include "TraceReader.h"
+
+struct ReplayOptions
+{
+    unsigned int Loops = 1;
+    bool FinishEachFrame = false; // 每帧 glFinish，把 GPU（llvmpipe）时间也算进帧时间
+    bool PerCallTiming = true;    // 关闭后只统计总吞吐量，避免计时本身的开销
+};
+
+// 把追踪的调用重新发给当前上下文，并统计每类调用的 CPU 开销
+class Replayer
+{
+private:
+    struct FuncStats
+    {
+        uint64_t Count = 0;
+        uint64_t TotalNs = 0;
+        uint64_t RecordedNs = 0;
+    };
+
+    const TraceReader& m_Trace;
+    ReplayOptions m_Options;
+
+    // 录制时的对象名 -> 回放时的对象名
+    std::unordered_map<uint64_t, GLuint> m_Buffers;
+    std::unordered_map<uint64_t, GLuint> m_VertexArrays;
+    std::unordered_map<uint64_t, GLuint> m_Textures;
+    std::unordered_map<uint64_t, GLuint> m_Shaders;
+    std::unordered_map<uint64_t, GLuint> m_Programs;
+    // (录制时的程序, 录制时的位置) -> 回放时的位置
+    std::unordered_map<uint64_t, GLint> m_UniformLocations;
+    // 录制时的同步对象指针 -> 回放时的同步对象
+    std::unordered_map<uint64_t, GLsync> m_Syncs;
+    // 绑定点 -> 映射的内存，刷新时在这里写入零数据
+    std::unordered_map<GLenum, char*> m_MappedTargets;
+    // 录制时的缓冲区名 -> 映射的内存（DSA）
+    std::unordered_map<uint64_t, char*> m_MappedBuffers;
+    uint64_t m_CurrentProgram;
+
+    std::vector<char> m_Scratch;
+    std::vector<FuncStats> m_FuncStats;
+    std::vector<double> m_FrameTimesMs;
+    uint64_t m_TotalCalls;
+    double m_TotalSeconds;
+public:
+    Replayer(const TraceReader& trace, const ReplayOptions& options);
+
+    void Run();
+    void PrintReport() const;
+private:
+    void Execute(const TraceCall& call);
+    void ReleaseObjects();
+    const void* Scratch(size_t size);
+    GLint MapLocation(uint64_t location) const;
+};
@@ -0,0 +1,118 @@
+#include "TraceReader.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+TraceReader::TraceReader() : m_FrameCount(0), m_UnknownCalls(0)
+{
+}
+
+bool TraceReader::Load(const std::string& filepath)
+{
+    std::ifstream stream(filepath, std::ios::binary);
+    if (!stream)
+    {
+        std::cout << "Cannot open trace " << filepath << std::endl;
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    auto read = [&](void* out, size_t size)
+    {
+        if (pos + size > data.size())
+            return false;
+        std::memcpy(out, data.data() + pos, size);
+        pos += size;
+        return true;
+    };
+
+    GLTraceFileHeader header;
+    // 版本 1 与 2 的记录格式相同，只是版本 1 不会把名字数组存为 Blob，按同样的方式解码即可
+    if (!read(&header, sizeof(header)) || header.Magic != GLTRACE_MAGIC
+        || header.Version < GLTRACE_MIN_VERSION || header.Version > GLTRACE_VERSION)
+    {
+        std::cout << "Not a GL trace (or unsupported version): " << filepath << std::endl;
+        return false;
+    }
+
+    // 文件里的函数编号按名字映射到当前编号，函数列表追加后录制的文件也能回放
+    uint16_t funcCount = 0;
+    read(&funcCount, sizeof(funcCount));
+    std::vector<GLTraceFunc> remap(funcCount, GLTraceFunc::Count);
+    for (uint16_t i = 0; i < funcCount; i++)
+    {
+        uint8_t length = 0;
+        char name[256];
+        if (!read(&length, sizeof(length)) || !read(name, length))
+            return false;
+        std::string funcName(name, length);
+        for (uint16_t f = 0; f < (uint16_t)GLTraceFunc::Count; f++)
+        {
+            if (funcName == GLTraceFuncName((GLTraceFunc)f))
+                remap[i] = (GLTraceFunc)f;
+        }
+    }
+
+    GLTraceChunkHeader chunk;
+    while (read(&chunk, sizeof(chunk)))
+    {
+        size_t end = pos + chunk.Size;
+        if (end > data.size())
+        {
+            std::cout << "Trace truncated, ignoring the last chunk" << std::endl;
+            break;
+        }
+
+        if (chunk.Type == (uint32_t)GLTraceChunk::Blob)
+        {
+            uint64_t hash = 0;
+            read(&hash, sizeof(hash));
+            m_Blobs[hash] = std::string(data.data() + pos, end - pos);
+        }
+        else if (chunk.Type == (uint32_t)GLTraceChunk::Calls)
+        {
+            uint32_t threadIndex = 0, count = 0;
+            read(&threadIndex, sizeof(threadIndex));
+            read(&count, sizeof(count));
+            for (uint32_t i = 0; i < count; i++)
+            {
+                GLTraceRecordHeader record;
+                if (!read(&record, sizeof(record)) || record.ArgCount > GLTRACE_MAX_ARGS)
+                    break;
+                TraceCall call = {};
+                call.Func = record.Func < remap.size() ? remap[record.Func] : GLTraceFunc::Count;
+                call.ArgCount = record.ArgCount;
+                call.HashMask = record.HashMask;
+                call.DurationNs = record.DurationNs;
+                call.TimestampNs = record.TimestampNs;
+                call.ThreadIndex = threadIndex;
+                read(call.Args, record.ArgCount * sizeof(uint64_t));
+
+                if (call.Func == GLTraceFunc::Count)
+                    m_UnknownCalls++;
+                else
+                    m_Calls.push_back(call);
+            }
+        }
+        pos = end;
+    }
+
+    std::stable_sort(m_Calls.begin(), m_Calls.end(), [](const TraceCall& a, const TraceCall& b)
+    {
+        return a.TimestampNs < b.TimestampNs;
+    });
+    m_FrameCount = (unsigned int)std::count_if(m_Calls.begin(), m_Calls.end(), [](const TraceCall& call)
+    {
+        return call.Func == GLTraceFunc::FrameEnd;
+    });
+    return true;
+}
+
+const std::string* TraceReader::GetBlob(uint64_t hash) const
+{
+    auto it = m_Blobs.find(hash);
+    return it != m_Blobs.end() ? &it->second : nullptr;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GLTraceFormat.h"
+
+struct TraceCall
+{
+    GLTraceFunc Func;
+    uint8_t ArgCount;
+    uint8_t HashMask;
+    uint32_t DurationNs;
+    uint64_t TimestampNs;
+    uint32_t ThreadIndex;
+    uint64_t Args[GLTRACE_MAX_ARGS];
+};
+
+// 把整个追踪文件读入内存：所有线程的调用按时间戳合并成一条序列
+class TraceReader
+{
+private:
+    std::vector<TraceCall> m_Calls;
+    std::unordered_map<uint64_t, std::string> m_Blobs;
+    unsigned int m_FrameCount;
+    unsigned int m_UnknownCalls;
+public:
+    TraceReader();
+
+    bool Load(const std::string& filepath);
+
+    inline const std::vector<TraceCall>& GetCalls() const { return m_Calls; }
+    inline unsigned int GetFrameCount() const { return m_FrameCount; }
+    inline unsigned int GetUnknownCalls() const { return m_UnknownCalls; }
+    const std::string* GetBlob(uint64_t hash) const;
+};
@@ -0,0 +1,62 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec4 a_Color;
+layout(location = 2) in vec2 a_TexCoord;
+layout(location = 3) in float a_TexIndex;
+
+uniform mat4 u_ViewProjection;
+
+out vec4 v_Color;
+out vec2 v_TexCoord;
+flat out int v_TexIndex;
+
+void main()
+{
+    v_Color = a_Color;
+    v_TexCoord = a_TexCoord;
+    v_TexIndex = int(a_TexIndex);
+    gl_Position = u_ViewProjection * vec4(a_Position, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+in vec2 v_TexCoord;
+flat in int v_TexIndex;
+
+uniform sampler2D u_Textures[16];
+
+// 3.30 只允许用常量表达式索引采样器数组，而且 v_TexIndex 在一个 2x2 像素块内也不一定相同，
+// 所以每个槽位写成字面量下标；导数在分支外求出，分支内用 textureGrad，避免非一致控制流中的隐式导数
+void main()
+{
+    vec2 dx = dFdx(v_TexCoord);
+    vec2 dy = dFdy(v_TexCoord);
+    vec4 texel;
+    switch (v_TexIndex)
+    {
+        case 0: texel = textureGrad(u_Textures[0], v_TexCoord, dx, dy); break;
+        case 1: texel = textureGrad(u_Textures[1], v_TexCoord, dx, dy); break;
+        case 2: texel = textureGrad(u_Textures[2], v_TexCoord, dx, dy); break;
+        case 3: texel = textureGrad(u_Textures[3], v_TexCoord, dx, dy); break;
+        case 4: texel = textureGrad(u_Textures[4], v_TexCoord, dx, dy); break;
+        case 5: texel = textureGrad(u_Textures[5], v_TexCoord, dx, dy); break;
+        case 6: texel = textureGrad(u_Textures[6], v_TexCoord, dx, dy); break;
+        case 7: texel = textureGrad(u_Textures[7], v_TexCoord, dx, dy); break;
+        case 8: texel = textureGrad(u_Textures[8], v_TexCoord, dx, dy); break;
+        case 9: texel = textureGrad(u_Textures[9], v_TexCoord, dx, dy); break;
+        case 10: texel = textureGrad(u_Textures[10], v_TexCoord, dx, dy); break;
+        case 11: texel = textureGrad(u_Textures[11], v_TexCoord, dx, dy); break;
+        case 12: texel = textureGrad(u_Textures[12], v_TexCoord, dx, dy); break;
+        case 13: texel = textureGrad(u_Textures[13], v_TexCoord, dx, dy); break;
+        case 14: texel = textureGrad(u_Textures[14], v_TexCoord, dx, dy); break;
+        case 15: texel = textureGrad(u_Textures[15], v_TexCoord, dx, dy); break;
+        default: texel = vec4(1.0); break;
+    }
+    color = texel * v_Color;
+}
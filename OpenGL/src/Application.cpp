@@ -6,12 +6,21 @@
 
 // 自定义渲染器和封装类头文件
 #include "Renderer.h"      // 渲染相关的辅助函数和宏（如 GLCall）
+#include "GLDebug.h"       // KHR_debug 调试输出回调
+#include "GLTrace.h"       // GL 调用录制
 #include "VertexBuffer.h"  // 封装的顶点缓冲对象类
 #include "IndexBuffer.h"   // 封装的索引缓冲对象类
 #include "VertexArray.h"   // 封装的顶点数组对象类
 #include "Shader.h"        // 封装的着色器类
-
-int main(void)
+#include "GLState.h"       // 影子状态缓存，跳过重复的绑定
+#include "DeletionQueue.h" // 延迟批量删除 GL 对象
+#include "GLCaps.h"        // 上下文能力检测（DSA 等）
+#include "ProgramBinaryCache.h" // 程序二进制的磁盘缓存
+#include "ShaderCompiler.h" // 异步编译着色器
+#include "ShaderPreprocessor.h" // 着色器 #include 和热重载
+#include "ShaderLibrary.h"  // 着色器变体和预热清单
+
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
@@ -19,6 +28,11 @@ int main(void)
     if (!glfwInit())
         return -1; // 初始化失败，程序退出
 
+#if GL_CHECK_LEVEL != GL_CHECK_OFF
+    // 请求调试上下文，以便驱动通过 KHR_debug 回调报告错误
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+
     // 创建一个窗口，大小为 640x480，标题为 "Hello World"
     window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
     if (!window)
@@ -40,6 +54,35 @@ int main(void)
     // 输出当前的 OpenGL 版本
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
 
+    // 检测能力并选择实现路径；--no-dsa 强制使用绑定后修改的旧路径，便于对比
+    bool allowDirectStateAccess = true;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--no-dsa")
+            allowDirectStateAccess = false;
+    }
+    GLCaps::Init(allowDirectStateAccess);
+    GLCaps::Print();
+
+    // 着色器程序链接后缓存到磁盘，之后启动时跳过编译
+    ProgramBinaryCache::Init("shadercache");
+    // 驱动支持时在后台线程编译着色器
+    ShaderCompiler::Init();
+    // #include <...> 从共享的着色器目录查找
+    ShaderPreprocessor::AddIncludeDirectory("OpenGL/res/shaders");
+
+#if GL_CHECK_LEVEL != GL_CHECK_OFF
+    // 注册调试输出回调（扩展不可用时继续使用 glGetError 检查）
+    GLDebug::Init();
+#endif
+
+    // 使用 --trace <文件> 启动时，把所有 GL 调用录制到追踪文件（需要以 GL_TRACE 编译）
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--trace")
+            GLTrace::Start(argv[i + 1]);
+    }
+
     {
         // 定义四个顶点的位置坐标（x, y）构成一个矩形（以两个三角形绘制）
         float postions[] = {
@@ -69,39 +112,39 @@ int main(void)
         // 创建索引缓冲对象，绑定索引数据
         IndexBuffer ib(indices, 6);
 
-        // 加载着色器程序，并进行绑定
-        Shader shader("OpenGL/res/shaders/Basic.shader");
-        shader.Bind();
-
-        // 设置一个 uniform 变量的初始颜色
-        shader.SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
+        // 按上次运行的清单预热用到的着色器变体；清单中没有的变体在第一次 Get 时开始异步编译
+        ShaderLibrary shaders;
+        shaders.Prewarm("shadercache/variants.manifest");
+        ShaderVariants& basicShader = shaders.Get("OpenGL/res/shaders/Basic.shader");
 
         // 解绑所有对象（防止之后误用）
         va.Unbind();
         vb.Unbind();
         ib.Unbind();
-        shader.Unbind();
+
+        // 渲染器：每帧提交绘制命令，排序后统一执行
+        Renderer renderer;
 
         // 控制颜色变化的变量
         float r = 0.0f;
         float increment = 0.05f;
+        double lastShaderPoll = glfwGetTime();
 
         // 主渲染循环
         while (!glfwWindowShouldClose(window))
         {
             // 清空颜色缓冲
-            glClear(GL_COLOR_BUFFER_BIT);
-
-            // 绑定着色器，并更新 uniform 颜色值
-            shader.Bind();
-            shader.SetUniform4f("u_Color", r, 0.3f, 0.8f, 1.0f);
+            renderer.Clear();
 
-            // 绑定 VAO 和索引缓冲准备绘制
-            va.Bind();
-            ib.Bind();
+            // 提交绘制命令：VAO、索引缓冲、着色器和这次绘制用到的 uniform 颜色值；
+            // 基础变体还在编译且没有后备程序时跳过这一帧的绘制
+            UniformSet uniforms;
+            uniforms.SetVec4("u_Color", r, 0.3f, 0.8f, 1.0f);
+            if (Shader* shader = basicShader.Get(0))
+                renderer.Submit(va, ib, *shader, uniforms);
 
-            // 调用封装的 GL 绘制宏，绘制两个三角形组成的矩形
-            GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+            // 排序并执行本帧的所有绘制命令（重复绑定由 GLState 跳过）
+            renderer.Flush();
 
             // 控制红色通道渐变
             if (r > 1.0f)
@@ -110,14 +153,47 @@ int main(void)
                 increment = 0.05f;
             r += increment;
 
+            // 回收 GPU 已用完的对象，检查异步编译的着色器是否完成
+            DeletionQueue::EndFrame();
+            ShaderCompiler::Poll();
+
+            // 每秒检查一次着色器文件，只重新构建依赖改动过的文件的程序
+            if (glfwGetTime() - lastShaderPoll > 1.0)
+            {
+                lastShaderPoll = glfwGetTime();
+                shaders.Reload(ShaderPreprocessor::PollChanges());
+            }
+
+            // 每帧统一检查一次 GL 错误（GL_CHECK_OFF 时为空操作）
+            GLCheckFrame();
+            GLTrace::FrameEnd();
+
             // 交换前后缓冲，显示新帧
             glfwSwapBuffers(window);
 
             // 处理窗口事件（键盘鼠标等）
             glfwPollEvents();
         }
+
+        // 还没完成的异步编译在资源作用域结束前收尾
+        ShaderCompiler::WaitAll();
+        shaders.SaveManifest("shadercache/variants.manifest");
     }
 
+    // 资源对象已在上面的作用域中析构，删除仍在排队的名字
+    DeletionQueue::Shutdown();
+    DeletionQueue::PrintStats();
+    ProgramBinaryCache::PrintStats();
+    ShaderPreprocessor::PrintStats();
+    ProgramBinaryCache::Shutdown();
+    GLState::PrintStats();
+    GLTrace::Stop();
+
+#if GL_CHECK_LEVEL != GL_CHECK_OFF
+    GLDebug::PrintSummary();
+    GLDebug::Shutdown();
+#endif
+
     // 程序结束前清理资源
     glfwTerminate();
     return 0;
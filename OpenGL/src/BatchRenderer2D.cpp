@@ -0,0 +1,148 @@
+#include "BatchRenderer2D.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include <cstring>
+#include <string>
+
+BatchRenderer2D::BatchRenderer2D(const std::string& shaderPath)
+    : m_VertexStream(GL_ARRAY_BUFFER, MaxVertices * sizeof(QuadVertex) * 2),
+      m_IndexBuffer(GenerateQuadIndices().data(), MaxIndices),
+      m_Shader(shaderPath),
+      m_WhiteTexture(0),
+      m_Vertices(nullptr),
+      m_QuadCount(0),
+      m_TextureSlotCount(1)
+{
+    m_VertexArray.AddBuffer<QuadLayout>(m_VertexStream);
+
+    unsigned int white = 0xFFFFFFFF;
+    GLCall(glGenTextures(1, &m_WhiteTexture));
+    GLState::BindTexture(0, GL_TEXTURE_2D, m_WhiteTexture);
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white));
+    m_TextureSlots[0] = m_WhiteTexture;
+
+    m_Shader.Bind();
+    for (unsigned int i = 0; i < MaxTextureSlots; i++)
+        m_Shader.SetUniform1i("u_Textures[" + std::to_string(i) + "]", i);
+}
+
+BatchRenderer2D::~BatchRenderer2D()
+{
+    DeletionQueue::DeleteTexture(m_WhiteTexture);
+}
+
+std::vector<unsigned int> BatchRenderer2D::GenerateQuadIndices()
+{
+    std::vector<unsigned int> indices(MaxIndices);
+    for (unsigned int quad = 0, vertex = 0; quad < MaxQuads; quad++, vertex += 4)
+    {
+        unsigned int* index = &indices[quad * 6];
+        index[0] = vertex + 0;
+        index[1] = vertex + 1;
+        index[2] = vertex + 2;
+        index[3] = vertex + 2;
+        index[4] = vertex + 3;
+        index[5] = vertex + 0;
+    }
+    return indices;
+}
+
+void BatchRenderer2D::Begin(const float* viewProjection)
+{
+    static const float identity[16] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    m_Shader.Bind();
+    m_Shader.SetUniformMat4f("u_ViewProjection", viewProjection ? viewProjection : identity);
+    m_QuadCount = 0;
+    m_TextureSlotCount = 1;
+}
+
+void BatchRenderer2D::DrawQuad(float x, float y, float width, float height, const float color[4])
+{
+    if (m_QuadCount == MaxQuads)
+        Flush();
+    PushQuad(x, y, width, height, color, 0.0f);
+}
+
+void BatchRenderer2D::DrawQuad(float x, float y, float width, float height, unsigned int texture, const float tint[4])
+{
+    if (m_QuadCount == MaxQuads)
+        Flush();
+
+    unsigned int slot = 0;
+    for (unsigned int i = 1; i < m_TextureSlotCount; i++)
+    {
+        if (m_TextureSlots[i] == texture)
+        {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == 0)
+    {
+        if (m_TextureSlotCount == MaxTextureSlots)
+            Flush();
+        slot = m_TextureSlotCount++;
+        m_TextureSlots[slot] = texture;
+    }
+    PushQuad(x, y, width, height, tint, (float)slot);
+}
+
+void BatchRenderer2D::PushQuad(float x, float y, float width, float height, const float color[4], float texIndex)
+{
+    static const float corners[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+    if (!m_Vertices)
+        m_Vertices = (QuadVertex*)m_VertexStream.Map(MaxVertices * sizeof(QuadVertex), sizeof(QuadVertex));
+
+    QuadVertex* vertex = &m_Vertices[m_QuadCount * 4];
+    for (int i = 0; i < 4; i++, vertex++)
+    {
+        vertex->Position[0] = x + corners[i][0] * width;
+        vertex->Position[1] = y + corners[i][1] * height;
+        vertex->Position[2] = 0.0f;
+        std::memcpy(vertex->Color, color, 4 * sizeof(float));
+        vertex->TexCoord[0] = corners[i][0];
+        vertex->TexCoord[1] = corners[i][1];
+        vertex->TexIndex = texIndex;
+    }
+    m_QuadCount++;
+    m_Stats.Quads++;
+}
+
+void BatchRenderer2D::End()
+{
+    Flush();
+    m_VertexStream.EndFrame();
+}
+
+void BatchRenderer2D::Flush()
+{
+    if (m_QuadCount == 0)
+        return;
+
+    unsigned int size = m_QuadCount * 4 * sizeof(QuadVertex);
+    unsigned int offset = m_VertexStream.Unmap(size);
+    m_Vertices = nullptr;
+
+    for (unsigned int i = 0; i < m_TextureSlotCount; i++)
+        GLState::BindTexture(i, GL_TEXTURE_2D, m_TextureSlots[i]);
+
+    m_Shader.Bind();
+    m_VertexArray.Bind();
+    m_IndexBuffer.Bind();
+    // 每个批次的顶点位于流式缓冲中的不同位置，用 baseVertex 偏移，索引和 VAO 不变
+    GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, m_QuadCount * 6, m_IndexBuffer.GetType(), nullptr, offset / sizeof(QuadVertex)));
+
+    m_Stats.Batches++;
+    m_Stats.BytesUploaded += size;
+    m_QuadCount = 0;
+    m_TextureSlotCount = 1;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "VertexArray.h"
+#include "StreamBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+
+struct QuadVertex
+{
+    float Position[3];
+    float Color[4];
+    float TexCoord[2];
+    float TexIndex;
+};
+
+using QuadLayout = VertexLayout<QuadVertex,
+    VERTEX_ATTRIBUTE(QuadVertex, Position),
+    VERTEX_ATTRIBUTE(QuadVertex, Color),
+    VERTEX_ATTRIBUTE(QuadVertex, TexCoord),
+    VERTEX_ATTRIBUTE(QuadVertex, TexIndex)>;
+
+struct BatchStats
+{
+    unsigned int Quads = 0;
+    unsigned int Batches = 0;
+    unsigned long long BytesUploaded = 0;
+};
+
+// 2D 四边形批量渲染：顶点直接写入映射的流式缓冲，所有批次共用一份预生成的索引，
+// 批次容量或纹理槽用完时才提交一次 glDrawElementsBaseVertex
+class BatchRenderer2D
+{
+public:
+    static const unsigned int MaxQuads = 10000;
+    static const unsigned int MaxVertices = MaxQuads * 4;
+    static const unsigned int MaxIndices = MaxQuads * 6;
+    static const unsigned int MaxTextureSlots = 16; // 槽 0 固定为 1x1 白色纹理
+private:
+    VertexArray m_VertexArray;
+    StreamBuffer m_VertexStream;
+    IndexBuffer m_IndexBuffer;
+    Shader m_Shader;
+    unsigned int m_WhiteTexture;
+
+    QuadVertex* m_Vertices; // 当前批次在映射内存中的写入位置，未映射时为 nullptr
+    unsigned int m_QuadCount;
+    unsigned int m_TextureSlots[MaxTextureSlots];
+    unsigned int m_TextureSlotCount;
+    BatchStats m_Stats;
+public:
+    BatchRenderer2D(const std::string& shaderPath);
+    ~BatchRenderer2D();
+
+    // viewProjection 为列主序 4x4 矩阵，传 nullptr 时使用单位矩阵（直接使用裁剪空间坐标）
+    void Begin(const float* viewProjection = nullptr);
+    void DrawQuad(float x, float y, float width, float height, const float color[4]);
+    void DrawQuad(float x, float y, float width, float height, unsigned int texture, const float tint[4]);
+    // 每帧调用一次：提交剩余的四边形并让流式缓冲进入下一帧的区域
+    void End();
+
+    inline const BatchStats& GetStats() const { return m_Stats; }
+    inline void ResetStats() { m_Stats = BatchStats(); }
+private:
+    static std::vector<unsigned int> GenerateQuadIndices();
+    void PushQuad(float x, float y, float width, float height, const float color[4], float texIndex);
+    void Flush();
+};
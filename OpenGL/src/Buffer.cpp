@@ -0,0 +1,304 @@
+#include "Buffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "GLCaps.h"
+#include "BufferPool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // 间隔小于这个值的脏区间合并成一个，少一次调用比少传几十字节更划算
+    const unsigned int MergeGap = 64;
+}
+
+unsigned int GetGLUsage(BufferUsage usage)
+{
+    switch (usage)
+    {
+    case BufferUsage::Static:  return GL_STATIC_DRAW;
+    case BufferUsage::Dynamic: return GL_DYNAMIC_DRAW;
+    case BufferUsage::Stream:  return GL_STREAM_DRAW;
+    }
+    ASSERT(false);
+    return GL_STATIC_DRAW;
+}
+
+Buffer::Buffer(unsigned int target, const void* data, unsigned int size, BufferUsage usage)
+    : m_Target(target), m_RendererID(0), m_Size(size), m_Usage(usage),
+      m_MapSize(0), m_BytesUploaded(data ? size : 0), m_Pool(nullptr), m_Allocation(), m_Offset(0)
+{
+    m_RendererID = DeletionQueue::AcquireBuffer();
+    if (GLCaps::HasDirectStateAccess())
+    {
+        GLCall(glNamedBufferData(m_RendererID, size, data, GetGLUsage(usage)));
+    }
+    else
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        GLCall(glBufferData(m_Target, size, data, GetGLUsage(usage)));
+    }
+
+    if (m_Usage != BufferUsage::Static)
+    {
+        m_Shadow.resize(size);
+        if (data)
+            std::memcpy(m_Shadow.data(), data, size);
+    }
+}
+
+Buffer::Buffer(BufferPool& pool, const void* data, unsigned int size, unsigned int alignment, BufferUsage usage)
+    : m_Target(pool.GetTarget()), m_Size(size), m_Usage(usage),
+      m_MapSize(0), m_BytesUploaded(0), m_Pool(&pool)
+{
+    m_Allocation = pool.Allocate(size, alignment);
+    m_RendererID = m_Allocation.Buffer;
+    m_Offset = m_Allocation.Offset;
+
+    if (m_Usage != BufferUsage::Static)
+        m_Shadow.resize(size);
+    if (data)
+        SetSubData(data, 0, size);
+}
+
+Buffer::~Buffer()
+{
+    Release();
+}
+
+Buffer::Buffer(Buffer&& other) noexcept
+    : m_Target(other.m_Target), m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_Usage(other.m_Usage),
+      m_Shadow(std::move(other.m_Shadow)), m_DirtyRanges(std::move(other.m_DirtyRanges)), m_MapSize(other.m_MapSize),
+      m_BytesUploaded(other.m_BytesUploaded), m_Pool(other.m_Pool), m_Allocation(other.m_Allocation), m_Offset(other.m_Offset)
+{
+    other.m_RendererID = 0;
+    other.m_MapSize = 0;
+    other.m_Pool = nullptr;
+}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_Target = other.m_Target;
+        m_RendererID = other.m_RendererID;
+        m_Size = other.m_Size;
+        m_Usage = other.m_Usage;
+        m_Shadow = std::move(other.m_Shadow);
+        m_DirtyRanges = std::move(other.m_DirtyRanges);
+        m_MapSize = other.m_MapSize;
+        m_BytesUploaded = other.m_BytesUploaded;
+        m_Pool = other.m_Pool;
+        m_Allocation = other.m_Allocation;
+        m_Offset = other.m_Offset;
+        other.m_RendererID = 0;
+        other.m_MapSize = 0;
+        other.m_Pool = nullptr;
+    }
+    return *this;
+}
+
+void Buffer::Release()
+{
+    if (m_Pool)
+    {
+        m_Pool->Free(m_Allocation);
+        m_Pool = nullptr;
+    }
+    else if (m_RendererID != 0)
+    {
+        DeletionQueue::DeleteBuffer(m_RendererID);
+    }
+    m_RendererID = 0;
+}
+
+void Buffer::Bind() const
+{
+    GLState::BindBuffer(m_Target, m_RendererID);
+}
+
+void Buffer::Unbind() const
+{
+    GLState::BindBuffer(m_Target, 0);
+}
+
+void Buffer::SetData(const void* data, unsigned int size)
+{
+    ASSERT(m_MapSize == 0);
+    if (m_Pool)
+    {
+        ASSERT(size <= m_Allocation.Size);
+        if (data)
+        {
+            UploadSubData(m_Offset, size, data);
+            m_BytesUploaded += size;
+        }
+    }
+    else
+    {
+        if (GLCaps::HasDirectStateAccess())
+        {
+            GLCall(glNamedBufferData(m_RendererID, size, data, GetGLUsage(m_Usage)));
+        }
+        else
+        {
+            GLState::BindBuffer(m_Target, m_RendererID);
+            GLCall(glBufferData(m_Target, size, data, GetGLUsage(m_Usage)));
+        }
+        if (data)
+            m_BytesUploaded += size;
+    }
+    m_Size = size;
+
+    m_DirtyRanges.clear();
+    if (m_Usage != BufferUsage::Static)
+    {
+        m_Shadow.resize(size);
+        if (data)
+            std::memcpy(m_Shadow.data(), data, size);
+    }
+}
+
+void Buffer::SetSubData(const void* data, unsigned int offset, unsigned int size)
+{
+    ASSERT(m_MapSize == 0 && offset + size <= m_Size);
+    UploadSubData(m_Offset + offset, size, data);
+    m_BytesUploaded += size;
+
+    if (!m_Shadow.empty())
+        std::memcpy(m_Shadow.data() + offset, data, size);
+}
+
+void Buffer::Orphan()
+{
+    ASSERT(m_MapSize == 0 && !m_Pool);
+    if (GLCaps::HasDirectStateAccess())
+    {
+        GLCall(glNamedBufferData(m_RendererID, m_Size, nullptr, GetGLUsage(m_Usage)));
+        return;
+    }
+    GLState::BindBuffer(m_Target, m_RendererID);
+    GLCall(glBufferData(m_Target, m_Size, nullptr, GetGLUsage(m_Usage)));
+}
+
+void* Buffer::Map(unsigned int offset, unsigned int size, bool invalidate)
+{
+    ASSERT(m_MapSize == 0 && size > 0 && offset + size <= m_Size);
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+    if (invalidate)
+        access |= GL_MAP_INVALIDATE_RANGE_BIT;
+
+    void* memory = nullptr;
+    if (GLCaps::HasDirectStateAccess())
+    {
+        GLCall(memory = glMapNamedBufferRange(m_RendererID, m_Offset + offset, size, access));
+    }
+    else
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        GLCall(memory = glMapBufferRange(m_Target, m_Offset + offset, size, access));
+    }
+    m_MapSize = size;
+    return memory;
+}
+
+void Buffer::Flush(unsigned int offset, unsigned int size)
+{
+    ASSERT(m_MapSize != 0 && offset + size <= m_MapSize);
+    if (GLCaps::HasDirectStateAccess())
+    {
+        GLCall(glFlushMappedNamedBufferRange(m_RendererID, offset, size));
+    }
+    else
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        GLCall(glFlushMappedBufferRange(m_Target, offset, size));
+    }
+    m_BytesUploaded += size;
+}
+
+void Buffer::Unmap()
+{
+    ASSERT(m_MapSize != 0);
+    if (GLCaps::HasDirectStateAccess())
+    {
+        GLCall(glUnmapNamedBuffer(m_RendererID));
+    }
+    else
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        GLCall(glUnmapBuffer(m_Target));
+    }
+    m_MapSize = 0;
+}
+
+void Buffer::UploadSubData(unsigned int offset, unsigned int size, const void* data)
+{
+    if (GLCaps::HasDirectStateAccess())
+    {
+        GLCall(glNamedBufferSubData(m_RendererID, offset, size, data));
+        return;
+    }
+    GLState::BindBuffer(m_Target, m_RendererID);
+    GLCall(glBufferSubData(m_Target, offset, size, data));
+}
+
+void Buffer::Write(const void* data, unsigned int offset, unsigned int size)
+{
+    ASSERT(!m_Shadow.empty() && offset + size <= m_Size);
+    if (size == 0)
+        return;
+    std::memcpy(m_Shadow.data() + offset, data, size);
+    MarkDirty(offset, size);
+}
+
+void Buffer::MarkDirty(unsigned int offset, unsigned int size)
+{
+    unsigned int end = offset + size;
+
+    // 找到第一个可能与 [offset, end) 重叠或相邻的区间，把能合并的都并进来
+    auto it = std::lower_bound(m_DirtyRanges.begin(), m_DirtyRanges.end(), offset,
+        [](const BufferRange& range, unsigned int value) { return range.Offset + range.Size + MergeGap < value; });
+    auto last = it;
+    while (last != m_DirtyRanges.end() && last->Offset <= end + MergeGap)
+    {
+        offset = std::min(offset, last->Offset);
+        end = std::max(end, last->Offset + last->Size);
+        ++last;
+    }
+    it = m_DirtyRanges.erase(it, last);
+    m_DirtyRanges.insert(it, BufferRange{ offset, end - offset });
+
+    // 区间太碎时退化为一个包围区间
+    if (m_DirtyRanges.size() > MaxDirtyRanges)
+    {
+        BufferRange bounds = { m_DirtyRanges.front().Offset,
+            m_DirtyRanges.back().Offset + m_DirtyRanges.back().Size - m_DirtyRanges.front().Offset };
+        m_DirtyRanges.assign(1, bounds);
+    }
+}
+
+unsigned int Buffer::Upload()
+{
+    if (m_DirtyRanges.empty())
+        return 0;
+
+    // 整块都脏了：孤立后重新上传，不必等待 GPU 读完旧内容
+    const BufferRange& first = m_DirtyRanges.front();
+    if (m_DirtyRanges.size() == 1 && first.Size == m_Size && !m_Pool)
+        Orphan();
+
+    // 每个区间一次 glBufferSubData，驱动把数据复制到暂存区，不用等 GPU 用完这个缓冲。
+    // 不映射包围区间：不带 invalidate 的映射要与 GPU 同步，带 invalidate 又会丢掉区间之间没改过的字节
+    unsigned int uploaded = 0;
+    for (const BufferRange& range : m_DirtyRanges)
+    {
+        UploadSubData(m_Offset + range.Offset, range.Size, m_Shadow.data() + range.Offset);
+        uploaded += range.Size;
+    }
+    m_BytesUploaded += uploaded;
+    m_DirtyRanges.clear();
+    return uploaded;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+
+enum class BufferUsage
+{
+    Static,  // 上传一次，绘制多次
+    Dynamic, // 经常局部更新
+    Stream   // 每帧整体重写
+};
+
+struct BufferRange
+{
+    unsigned int Offset;
+    unsigned int Size;
+};
+
+// BufferPool 分出的一段区间：所在的 GL 缓冲、字节偏移和大小，Page/Block 供释放时使用
+struct BufferAllocation
+{
+    unsigned int Buffer;
+    unsigned int Offset;
+    unsigned int Size;
+    unsigned int Page;
+    unsigned int Block;
+};
+
+class BufferPool;
+
+// VertexBuffer / IndexBuffer 的公共部分：按用途提示分配存储，支持整体替换、局部更新、
+// 孤立（orphan）和显式 flush 的 glMapBufferRange。
+// 非 Static 的缓冲在 CPU 侧保留一份副本，Write 只记录脏区间，Upload 时只把改动的字节传给 GPU。
+// 也可以由 BufferPool 的一段区间支撑，此时不拥有 GL 对象，所有偏移都相对于区间起点。
+// 支持 DSA（GL 4.5）时所有操作直接作用于缓冲名字，不改变任何绑定
+class Buffer
+{
+public:
+    static const unsigned int MaxDirtyRanges = 16;
+protected:
+    unsigned int m_Target;
+    unsigned int m_RendererID;
+    unsigned int m_Size;
+    BufferUsage m_Usage;
+    std::vector<unsigned char> m_Shadow;
+    std::vector<BufferRange> m_DirtyRanges; // 按偏移排序且互不相邻
+    unsigned int m_MapSize;    // 非 0 表示正处于映射状态
+    unsigned long long m_BytesUploaded;
+    BufferPool* m_Pool;
+    BufferAllocation m_Allocation;
+    unsigned int m_Offset;     // 在 GL 缓冲中的起始偏移，自有缓冲为 0
+
+    Buffer(unsigned int target, const void* data, unsigned int size, BufferUsage usage);
+    Buffer(BufferPool& pool, const void* data, unsigned int size, unsigned int alignment, BufferUsage usage);
+    ~Buffer();
+
+    // 只能移动：复制会让两个对象删除同一个 GL 缓冲
+    Buffer(Buffer&& other) noexcept;
+    Buffer& operator=(Buffer&& other) noexcept;
+public:
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    void Bind() const;
+    void Unbind() const;
+
+    // 整体替换内容，大小可以改变；glBufferData 会让驱动孤立旧存储而不是等待 GPU。
+    // 池中的缓冲不能超过分配时的大小，也不能孤立（会影响同一页里的其他网格）
+    void SetData(const void* data, unsigned int size);
+    // 立即更新 [offset, offset + size)
+    void SetSubData(const void* data, unsigned int offset, unsigned int size);
+    // 丢弃当前存储（内容变为未定义），之后的写入不必与仍在使用旧数据的绘制同步
+    void Orphan();
+
+    // 映射 [offset, offset + size) 用于写入，只有 Flush 过的部分保证传到 GPU；
+    // invalidate 为 true 时驱动可以丢弃这段的旧内容
+    void* Map(unsigned int offset, unsigned int size, bool invalidate = false);
+    // offset 相对于 Map 的起始位置
+    void Flush(unsigned int offset, unsigned int size);
+    void Unmap();
+
+    // 写入 CPU 副本并记录脏区间（仅非 Static 缓冲）
+    void Write(const void* data, unsigned int offset, unsigned int size);
+    // 把所有脏区间传给 GPU，返回上传的字节数
+    unsigned int Upload();
+
+    inline unsigned int GetRendererID() const { return m_RendererID; }
+    inline unsigned int GetSize() const { return m_Size; }
+    inline unsigned int GetOffset() const { return m_Offset; }
+    inline bool IsPooled() const { return m_Pool != nullptr; }
+    inline BufferUsage GetUsage() const { return m_Usage; }
+    inline bool IsDirty() const { return !m_DirtyRanges.empty(); }
+    inline unsigned long long GetBytesUploaded() const { return m_BytesUploaded; }
+private:
+    // offset 是 GL 缓冲中的绝对偏移；支持 DSA 时不改变绑定
+    void UploadSubData(unsigned int offset, unsigned int size, const void* data);
+    void MarkDirty(unsigned int offset, unsigned int size);
+    void Release();
+};
+
+unsigned int GetGLUsage(BufferUsage usage);
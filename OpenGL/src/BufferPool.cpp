@@ -0,0 +1,81 @@
+#include "BufferPool.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "GLCaps.h"
+
+BufferPool::BufferPool(unsigned int target, unsigned int pageSize, BufferUsage usage)
+    : m_Target(target), m_PageSize(pageSize), m_Usage(usage)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    for (const Page& page : m_Pages)
+        DeletionQueue::DeleteBuffer(page.RendererID, !page.Immutable);
+}
+
+void BufferPool::AddPage(unsigned int size)
+{
+    unsigned int id = DeletionQueue::AcquireBuffer();
+    // 页的大小固定且从不孤立，DSA 路径使用不可变存储；仍需支持 SetSubData 和 Map
+    bool immutable = GLCaps::HasDirectStateAccess();
+    if (immutable)
+    {
+        GLCall(glNamedBufferStorage(id, size, nullptr, GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT));
+    }
+    else
+    {
+        GLState::BindBuffer(m_Target, id);
+        GLCall(glBufferData(m_Target, size, nullptr, GetGLUsage(m_Usage)));
+    }
+    m_Pages.push_back({ id, immutable, TlsfAllocator(size) });
+}
+
+BufferAllocation BufferPool::Allocate(unsigned int size, unsigned int alignment)
+{
+    BufferAllocation allocation = {};
+    allocation.Size = size;
+    for (unsigned int i = 0; i < m_Pages.size(); i++)
+    {
+        allocation.Block = m_Pages[i].Allocator.Allocate(size, alignment, allocation.Offset);
+        if (allocation.Block != TlsfAllocator::Invalid)
+        {
+            allocation.Page = i;
+            allocation.Buffer = m_Pages[i].RendererID;
+            return allocation;
+        }
+    }
+
+    // 对齐可能需要额外的 alignment - 1 字节，TLSF 查找时还会把请求向上取整到下一个二级档位（最多 1/16）
+    unsigned int required = size + alignment + (size >> TlsfAllocator::SLBits);
+    unsigned int pageSize = required > m_PageSize ? required : m_PageSize;
+    AddPage(pageSize);
+    allocation.Page = (unsigned int)m_Pages.size() - 1;
+    allocation.Buffer = m_Pages.back().RendererID;
+    allocation.Block = m_Pages.back().Allocator.Allocate(size, alignment, allocation.Offset);
+    ASSERT(allocation.Block != TlsfAllocator::Invalid);
+    return allocation;
+}
+
+void BufferPool::Free(const BufferAllocation& allocation)
+{
+    ASSERT(allocation.Page < m_Pages.size() && m_Pages[allocation.Page].RendererID == allocation.Buffer);
+    m_Pages[allocation.Page].Allocator.Free(allocation.Block);
+}
+
+unsigned long long BufferPool::GetUsedBytes() const
+{
+    unsigned long long used = 0;
+    for (const Page& page : m_Pages)
+        used += page.Allocator.GetUsedBytes();
+    return used;
+}
+
+unsigned long long BufferPool::GetCapacity() const
+{
+    unsigned long long capacity = 0;
+    for (const Page& page : m_Pages)
+        capacity += page.Allocator.GetCapacity();
+    return capacity;
+}
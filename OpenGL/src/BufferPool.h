@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include "Buffer.h"
+#include "TlsfAllocator.h"
+
+// 从少数几个大 GL 缓冲（页）中切分区间给大量小网格使用，避免每个网格一个缓冲对象。
+// 同一页里的网格共用一个绑定：VAO 指向页的起始位置，绘制时用 baseVertex / 索引偏移选出各自的数据
+class BufferPool
+{
+private:
+    struct Page
+    {
+        unsigned int RendererID;
+        bool Immutable;
+        TlsfAllocator Allocator;
+    };
+
+    unsigned int m_Target;
+    unsigned int m_PageSize;
+    BufferUsage m_Usage;
+    std::vector<Page> m_Pages;
+public:
+    BufferPool(unsigned int target, unsigned int pageSize = 16 * 1024 * 1024, BufferUsage usage = BufferUsage::Static);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // 现有页都放不下时新建一页；超过页大小的请求单独占一页
+    BufferAllocation Allocate(unsigned int size, unsigned int alignment = 4);
+    void Free(const BufferAllocation& allocation);
+
+    inline unsigned int GetTarget() const { return m_Target; }
+    inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+    inline unsigned int GetPageRendererID(unsigned int page) const { return m_Pages[page].RendererID; }
+    unsigned long long GetUsedBytes() const;
+    unsigned long long GetCapacity() const;
+private:
+    void AddPage(unsigned int size);
+};
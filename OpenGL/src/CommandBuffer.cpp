@@ -0,0 +1,219 @@
+#include "CommandBuffer.h"
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include <cstring>
+
+namespace
+{
+    struct UniformPacket
+    {
+        const std::string* Name; // UniformSet::Intern 的结果，执行时不必再构造字符串
+        UniformType Type;
+        unsigned int ValueSize;
+        // 之后是值
+    };
+
+    struct BindVertexBufferPacket
+    {
+        const VertexArray* Format;
+        const VertexBuffer* Buffer;
+        unsigned int Binding;
+    };
+
+    struct DrawElementsPacket
+    {
+        unsigned int Count;
+        unsigned int Type;
+        unsigned int Offset;
+        unsigned int InstanceCount;
+        int BaseVertex;
+    };
+
+    inline size_t Align8(size_t size)
+    {
+        return (size + 7) & ~(size_t)7;
+    }
+}
+
+CommandBuffer::CommandBuffer() : m_PacketCount(0)
+{
+}
+
+void CommandBuffer::Reset()
+{
+    m_Data.clear();
+    m_PacketCount = 0;
+}
+
+void* CommandBuffer::Allocate(PacketType type, size_t payloadSize)
+{
+    size_t size = Align8(sizeof(PacketHeader) + payloadSize);
+    ASSERT(size <= 0xFFFF);
+    size_t offset = m_Data.size();
+    m_Data.resize(offset + size);
+
+    PacketHeader* header = (PacketHeader*)&m_Data[offset];
+    header->Type = type;
+    header->Size = (unsigned short)size;
+    m_PacketCount++;
+    return header + 1;
+}
+
+void CommandBuffer::BindProgram(Shader& shader)
+{
+    Shader* pointer = &shader;
+    std::memcpy(Allocate(PacketType::BindProgram, sizeof(pointer)), &pointer, sizeof(pointer));
+}
+
+void CommandBuffer::BindVertexArray(const VertexArray& va)
+{
+    const VertexArray* pointer = &va;
+    std::memcpy(Allocate(PacketType::BindVertexArray, sizeof(pointer)), &pointer, sizeof(pointer));
+}
+
+void CommandBuffer::BindIndexBuffer(const IndexBuffer& ib)
+{
+    const IndexBuffer* pointer = &ib;
+    std::memcpy(Allocate(PacketType::BindIndexBuffer, sizeof(pointer)), &pointer, sizeof(pointer));
+}
+
+void CommandBuffer::BindVertexBuffer(const VertexArray& format, unsigned int binding, const VertexBuffer& vb)
+{
+    BindVertexBufferPacket packet = { &format, &vb, binding };
+    std::memcpy(Allocate(PacketType::BindVertexBuffer, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::SetUniform(const std::string& name, UniformType type, const void* values, size_t valueSize)
+{
+    unsigned char* payload = (unsigned char*)Allocate(PacketType::Uniform, sizeof(UniformPacket) + valueSize);
+    UniformPacket packet = { UniformSet::Intern(name), type, (unsigned int)valueSize };
+    std::memcpy(payload, &packet, sizeof(packet));
+    std::memcpy(payload + sizeof(packet), values, valueSize);
+}
+
+void CommandBuffer::SetUniformInt(const std::string& name, int value)
+{
+    SetUniform(name, UniformType::Int, &value, sizeof(value));
+}
+
+void CommandBuffer::SetUniformFloat(const std::string& name, float value)
+{
+    SetUniform(name, UniformType::Float, &value, sizeof(value));
+}
+
+void CommandBuffer::SetUniformVec4(const std::string& name, float v0, float v1, float v2, float v3)
+{
+    float values[4] = { v0, v1, v2, v3 };
+    SetUniform(name, UniformType::Vec4, values, sizeof(values));
+}
+
+void CommandBuffer::SetUniformMat4(const std::string& name, const float* matrix)
+{
+    SetUniform(name, UniformType::Mat4, matrix, 16 * sizeof(float));
+}
+
+void CommandBuffer::DrawElements(unsigned int count, unsigned int type, unsigned int offset, int baseVertex)
+{
+    DrawElementsInstanced(count, 1, type, offset, baseVertex);
+}
+
+void CommandBuffer::DrawElementsInstanced(unsigned int count, unsigned int instanceCount, unsigned int type, unsigned int offset, int baseVertex)
+{
+    DrawElementsPacket packet = { count, type, offset, instanceCount, baseVertex };
+    std::memcpy(Allocate(PacketType::DrawElements, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader, int baseVertex)
+{
+    BindProgram(shader);
+    BindVertexArray(va);
+    BindIndexBuffer(ib);
+    DrawElements(ib.GetCount(), ib.GetType(), ib.GetOffset(), baseVertex);
+}
+
+void CommandBuffer::Execute() const
+{
+    Shader* program = nullptr;
+    size_t offset = 0;
+    while (offset < m_Data.size())
+    {
+        const PacketHeader* header = (const PacketHeader*)&m_Data[offset];
+        const unsigned char* payload = (const unsigned char*)(header + 1);
+        offset += header->Size;
+
+        switch (header->Type)
+        {
+        case PacketType::BindProgram:
+            std::memcpy(&program, payload, sizeof(program));
+            program->Bind();
+            break;
+        case PacketType::BindVertexArray:
+        {
+            const VertexArray* va;
+            std::memcpy(&va, payload, sizeof(va));
+            va->Bind();
+            break;
+        }
+        case PacketType::BindIndexBuffer:
+        {
+            const IndexBuffer* ib;
+            std::memcpy(&ib, payload, sizeof(ib));
+            ib->Bind();
+            break;
+        }
+        case PacketType::BindVertexBuffer:
+        {
+            BindVertexBufferPacket packet;
+            std::memcpy(&packet, payload, sizeof(packet));
+            packet.Format->Bind();
+            packet.Format->BindVertexBuffer(packet.Binding, *packet.Buffer);
+            break;
+        }
+        case PacketType::Uniform:
+        {
+            ASSERT(program);
+            UniformPacket packet;
+            std::memcpy(&packet, payload, sizeof(packet));
+            const unsigned char* values = payload + sizeof(packet);
+            const std::string& name = *packet.Name;
+            float floats[16];
+            int intValue;
+            switch (packet.Type)
+            {
+            case UniformType::Int:
+                std::memcpy(&intValue, values, sizeof(intValue));
+                program->SetUniform1i(name, intValue);
+                break;
+            case UniformType::Float:
+                std::memcpy(floats, values, sizeof(float));
+                program->SetUniform1f(name, floats[0]);
+                break;
+            case UniformType::Vec4:
+                std::memcpy(floats, values, 4 * sizeof(float));
+                program->SetUniform4f(name, floats[0], floats[1], floats[2], floats[3]);
+                break;
+            case UniformType::Mat4:
+                std::memcpy(floats, values, 16 * sizeof(float));
+                program->SetUniformMat4f(name, floats);
+                break;
+            }
+            break;
+        }
+        case PacketType::DrawElements:
+        {
+            DrawElementsPacket packet;
+            std::memcpy(&packet, payload, sizeof(packet));
+            Renderer::DrawElements(packet.Count, packet.Type, packet.Offset, packet.InstanceCount, packet.BaseVertex);
+            break;
+        }
+        }
+    }
+}
+
+void CommandBuffer::ExecuteAll(const std::vector<CommandBuffer>& buffers)
+{
+    for (const CommandBuffer& buffer : buffers)
+        buffer.Execute();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+#include "UniformSet.h"
+#include "WorkerPool.h"
+
+class VertexArray;
+class VertexBuffer;
+class IndexBuffer;
+class Shader;
+
+// 可录制的命令缓冲：只往普通内存里写绑定/uniform/绘制数据包，不调用任何 GL 函数，
+// 所以可以在任意工作线程中录制；之后由 GL 线程按顺序 Execute
+class CommandBuffer
+{
+private:
+    enum class PacketType : unsigned short
+    {
+        BindProgram, BindVertexArray, BindIndexBuffer, Uniform, DrawElements, BindVertexBuffer
+    };
+
+    struct PacketHeader
+    {
+        PacketType Type;
+        unsigned short Size; // 包含头部，按 8 字节对齐
+    };
+
+    std::vector<unsigned char> m_Data;
+    unsigned int m_PacketCount;
+public:
+    CommandBuffer();
+
+    // 清空已录制的命令，保留已分配的内存
+    void Reset();
+
+    void BindProgram(Shader& shader);
+    void BindVertexArray(const VertexArray& va);
+    void BindIndexBuffer(const IndexBuffer& ib);
+    // 把 vb 挂到格式 VAO 的绑定点上（见 VertexArray::AddFormat），同时绑定这个 VAO
+    void BindVertexBuffer(const VertexArray& format, unsigned int binding, const VertexBuffer& vb);
+    void SetUniformInt(const std::string& name, int value);
+    void SetUniformFloat(const std::string& name, float value);
+    void SetUniformVec4(const std::string& name, float v0, float v1, float v2, float v3);
+    void SetUniformMat4(const std::string& name, const float* matrix);
+    void DrawElements(unsigned int count, unsigned int type = GL_UNSIGNED_INT, unsigned int offset = 0, int baseVertex = 0);
+    void DrawElementsInstanced(unsigned int count, unsigned int instanceCount, unsigned int type = GL_UNSIGNED_INT,
+        unsigned int offset = 0, int baseVertex = 0);
+    // 等价于 Renderer::Draw：绑定程序、VAO、索引缓冲并绘制全部索引
+    void Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader, int baseVertex = 0);
+
+    // 只能在 GL 线程调用
+    void Execute() const;
+
+    inline unsigned int GetPacketCount() const { return m_PacketCount; }
+    inline size_t GetSize() const { return m_Data.size(); }
+
+    // 把 [0, itemCount) 平均分给每个命令缓冲，由常驻的 WorkerPool 并行调用 record(buffer, begin, end)
+    template<typename Fn>
+    static void RecordParallel(std::vector<CommandBuffer>& buffers, unsigned int itemCount, Fn record)
+    {
+        unsigned int chunk = buffers.empty() ? 0 : (itemCount + (unsigned int)buffers.size() - 1) / (unsigned int)buffers.size();
+        auto task = [&buffers, &record, chunk, itemCount](unsigned int i)
+        {
+            unsigned int begin = i * chunk < itemCount ? i * chunk : itemCount;
+            unsigned int end = begin + chunk < itemCount ? begin + chunk : itemCount;
+            buffers[i].Reset();
+            record(buffers[i], begin, end);
+        };
+        WorkerPool::Get().Run((unsigned int)buffers.size(), task);
+    }
+
+    static void ExecuteAll(const std::vector<CommandBuffer>& buffers);
+private:
+    void* Allocate(PacketType type, size_t payloadSize);
+    void SetUniform(const std::string& name, UniformType type, const void* values, size_t valueSize);
+};
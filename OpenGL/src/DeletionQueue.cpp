@@ -0,0 +1,216 @@
+#include "DeletionQueue.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "GLCaps.h"
+#include <deque>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct Batch
+    {
+        GLsync Fence = nullptr;
+        unsigned long long Frame = 0;
+        std::vector<unsigned int> Buffers;
+        std::vector<unsigned int> RecyclableBuffers;
+        std::vector<unsigned int> VertexArrays;
+        std::vector<unsigned int> Textures;
+        std::vector<unsigned int> Programs;
+
+        bool Empty() const
+        {
+            return Buffers.empty() && RecyclableBuffers.empty() && VertexArrays.empty() && Textures.empty() && Programs.empty();
+        }
+    };
+
+    Batch s_Pending;
+    std::deque<Batch> s_InFlight;
+    std::vector<unsigned int> s_FreeBuffers;
+    unsigned long long s_Frame = 0;
+    DeletionStats s_Stats;
+
+    void DeleteBuffers(std::vector<unsigned int>& buffers)
+    {
+        if (buffers.empty())
+            return;
+        GLCall(glDeleteBuffers((GLsizei)buffers.size(), buffers.data()));
+        for (unsigned int buffer : buffers)
+            GLState::OnBufferDeleted(buffer);
+        s_Stats.Deleted += (unsigned int)buffers.size();
+        s_Stats.DeleteCalls++;
+        buffers.clear();
+    }
+
+    void Release(Batch& batch)
+    {
+        // 可回收的缓冲先释放存储再放回空闲列表，超出上限的部分一起删除
+        for (unsigned int buffer : batch.RecyclableBuffers)
+        {
+            if (s_FreeBuffers.size() < DeletionQueue::MaxRecycledBuffers)
+            {
+                if (GLCaps::HasDirectStateAccess())
+                {
+                    GLCall(glNamedBufferData(buffer, 0, nullptr, GL_STATIC_DRAW));
+                }
+                else
+                {
+                    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+                    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, 0, nullptr, GL_STATIC_DRAW));
+                }
+                s_FreeBuffers.push_back(buffer);
+            }
+            else
+            {
+                batch.Buffers.push_back(buffer);
+            }
+        }
+        batch.RecyclableBuffers.clear();
+        DeleteBuffers(batch.Buffers);
+
+        if (!batch.VertexArrays.empty())
+        {
+            GLCall(glDeleteVertexArrays((GLsizei)batch.VertexArrays.size(), batch.VertexArrays.data()));
+            for (unsigned int vertexArray : batch.VertexArrays)
+                GLState::OnVertexArrayDeleted(vertexArray);
+            s_Stats.Deleted += (unsigned int)batch.VertexArrays.size();
+            s_Stats.DeleteCalls++;
+        }
+        if (!batch.Textures.empty())
+        {
+            GLCall(glDeleteTextures((GLsizei)batch.Textures.size(), batch.Textures.data()));
+            for (unsigned int texture : batch.Textures)
+                GLState::OnTextureDeleted(texture);
+            s_Stats.Deleted += (unsigned int)batch.Textures.size();
+            s_Stats.DeleteCalls++;
+        }
+        // 程序没有批量删除的接口
+        for (unsigned int program : batch.Programs)
+        {
+            GLCall(glDeleteProgram(program));
+            GLState::OnProgramDeleted(program);
+            s_Stats.Deleted++;
+            s_Stats.DeleteCalls++;
+        }
+
+        if (batch.Fence)
+        {
+            GLCall(glDeleteSync(batch.Fence));
+        }
+        batch = Batch();
+    }
+}
+
+void DeletionQueue::DeleteBuffer(unsigned int buffer, bool recyclable)
+{
+    if (buffer == 0)
+        return;
+    (recyclable ? s_Pending.RecyclableBuffers : s_Pending.Buffers).push_back(buffer);
+    s_Stats.Queued++;
+}
+
+void DeletionQueue::DeleteVertexArray(unsigned int vertexArray)
+{
+    if (vertexArray == 0)
+        return;
+    s_Pending.VertexArrays.push_back(vertexArray);
+    s_Stats.Queued++;
+}
+
+void DeletionQueue::DeleteTexture(unsigned int texture)
+{
+    if (texture == 0)
+        return;
+    s_Pending.Textures.push_back(texture);
+    s_Stats.Queued++;
+}
+
+void DeletionQueue::DeleteProgram(unsigned int program)
+{
+    if (program == 0)
+        return;
+    s_Pending.Programs.push_back(program);
+    s_Stats.Queued++;
+}
+
+unsigned int DeletionQueue::AcquireBuffer()
+{
+    if (!s_FreeBuffers.empty())
+    {
+        unsigned int buffer = s_FreeBuffers.back();
+        s_FreeBuffers.pop_back();
+        s_Stats.Recycled++;
+        return buffer;
+    }
+    // DSA 函数要求名字已经对应一个缓冲对象，glGenBuffers 的名字要到第一次绑定才创建对象
+    unsigned int buffer = 0;
+    if (GLCaps::HasDirectStateAccess())
+    {
+        GLCall(glCreateBuffers(1, &buffer));
+    }
+    else
+    {
+        GLCall(glGenBuffers(1, &buffer));
+    }
+    return buffer;
+}
+
+void DeletionQueue::EndFrame()
+{
+    s_Frame++;
+    if (!s_Pending.Empty())
+    {
+        s_Pending.Frame = s_Frame;
+        if (GLCaps::Get().Sync)
+        {
+            GLCall(s_Pending.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        }
+        s_InFlight.push_back(std::move(s_Pending));
+        s_Pending = Batch();
+    }
+
+    // 批次按提交顺序完成，遇到第一个未完成的就停下；只轮询，不等待
+    while (!s_InFlight.empty())
+    {
+        Batch& batch = s_InFlight.front();
+        if (batch.Fence)
+        {
+            GLCall(GLenum result = glClientWaitSync(batch.Fence, 0, 0));
+            if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+                break;
+        }
+        else if (s_Frame - batch.Frame < FramesInFlight)
+        {
+            break;
+        }
+        Release(batch);
+        s_InFlight.pop_front();
+    }
+}
+
+void DeletionQueue::Shutdown()
+{
+    GLCall(glFinish());
+    if (!s_Pending.Empty())
+    {
+        s_InFlight.push_back(std::move(s_Pending));
+        s_Pending = Batch();
+    }
+    while (!s_InFlight.empty())
+    {
+        Release(s_InFlight.front());
+        s_InFlight.pop_front();
+    }
+    DeleteBuffers(s_FreeBuffers);
+}
+
+const DeletionStats& DeletionQueue::GetStats()
+{
+    return s_Stats;
+}
+
+void DeletionQueue::PrintStats()
+{
+    std::cout << "[DeletionQueue] queued " << s_Stats.Queued << ", deleted " << s_Stats.Deleted
+        << " in " << s_Stats.DeleteCalls << " calls, recycled " << s_Stats.Recycled << " buffer names" << std::endl;
+}
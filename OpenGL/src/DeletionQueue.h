@@ -0,0 +1,37 @@
+#pragma once
+
+struct DeletionStats
+{
+    unsigned int Queued = 0;
+    unsigned int Deleted = 0;
+    unsigned int DeleteCalls = 0;   // 实际发出的 glDelete* 调用次数
+    unsigned int Recycled = 0;      // 回收后被重新使用的缓冲名字
+};
+
+// 延迟、批量删除 GL 对象：析构函数只把名字放进当前帧的批次，EndFrame 为这一批插入栅栏，
+// 栅栏完成（GPU 已经执行完引用这些对象的帧）后才用一次 glDelete* 删除整批。
+// 普通（可变存储）缓冲的名字不删除，缩小为 0 字节后留给 AcquireBuffer 复用
+class DeletionQueue
+{
+public:
+    static const unsigned int MaxRecycledBuffers = 256;
+    // 不支持 ARB_sync 时按帧数估计 GPU 进度
+    static const unsigned int FramesInFlight = 3;
+
+    // recyclable 为 false 的缓冲（glBufferStorage 分配的不可变存储）总是删除
+    static void DeleteBuffer(unsigned int buffer, bool recyclable = true);
+    static void DeleteVertexArray(unsigned int vertexArray);
+    static void DeleteTexture(unsigned int texture);
+    static void DeleteProgram(unsigned int program);
+
+    // 优先返回回收的名字，没有时调用 glGenBuffers
+    static unsigned int AcquireBuffer();
+
+    // 每帧结束时调用一次
+    static void EndFrame();
+    // 等待 GPU 并立即删除所有排队的对象和回收的名字，在销毁上下文之前调用
+    static void Shutdown();
+
+    static const DeletionStats& GetStats();
+    static void PrintStats();
+};
@@ -0,0 +1,40 @@
+#include "GLCaps.h"
+#include "Renderer.h"
+#include <iostream>
+
+namespace
+{
+    // Init 之前全部为 false，所有代码走兼容路径
+    GLCapabilities s_Caps;
+}
+
+void GLCaps::Init(bool allowDirectStateAccess)
+{
+    s_Caps.DirectStateAccess = allowDirectStateAccess && (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access);
+    s_Caps.VertexAttribBinding = GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+    s_Caps.BufferStorage = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+    s_Caps.Sync = GLEW_VERSION_3_2 || GLEW_ARB_sync;
+
+    GLint binaryFormats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+    {
+        GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats));
+    }
+    s_Caps.ProgramBinary = binaryFormats > 0;
+    s_Caps.ParallelShaderCompile = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
+const GLCapabilities& GLCaps::Get()
+{
+    return s_Caps;
+}
+
+void GLCaps::Print()
+{
+    std::cout << "[GLCaps] direct state access: " << (s_Caps.DirectStateAccess ? "yes" : "no")
+        << ", vertex attrib binding: " << (s_Caps.VertexAttribBinding ? "yes" : "no")
+        << ", buffer storage: " << (s_Caps.BufferStorage ? "yes" : "no")
+        << ", sync: " << (s_Caps.Sync ? "yes" : "no")
+        << ", program binary: " << (s_Caps.ProgramBinary ? "yes" : "no")
+        << ", parallel shader compile: " << (s_Caps.ParallelShaderCompile ? "yes" : "no") << std::endl;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// 启动时检测一次的上下文能力，各个封装类据此选择实现路径
+struct GLCapabilities
+{
+    bool DirectStateAccess = false;     // GL 4.5 / ARB_direct_state_access
+    bool VertexAttribBinding = false;   // GL 4.3 / ARB_vertex_attrib_binding
+    bool BufferStorage = false;         // GL 4.4 / ARB_buffer_storage
+    bool Sync = false;                  // GL 3.2 / ARB_sync
+    bool ProgramBinary = false;         // GL 4.1 / ARB_get_program_binary，且驱动至少支持一种二进制格式
+    bool ParallelShaderCompile = false; // KHR / ARB_parallel_shader_compile
+};
+
+class GLCaps
+{
+public:
+    // 在初始化 GLEW 之后、创建任何 GL 对象之前调用；allowDirectStateAccess 为 false 时强制使用绑定后修改的旧路径
+    static void Init(bool allowDirectStateAccess = true);
+
+    static const GLCapabilities& Get();
+    inline static bool HasDirectStateAccess() { return Get().DirectStateAccess; }
+    static void Print();
+};
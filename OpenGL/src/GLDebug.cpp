@@ -0,0 +1,202 @@
+#include "GLDebug.h"
+#include "Renderer.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    struct DebugState
+    {
+        GLDebugConfig Config;
+        bool Active = false;
+        std::atomic<bool> ErrorRaised{ false };
+
+        std::mutex Mutex;
+        std::unordered_map<unsigned long long, unsigned int> Repeats;
+        std::chrono::steady_clock::time_point WindowStart;
+        unsigned int WindowCount = 0;
+        unsigned int Dropped = 0;
+        unsigned int Suppressed = 0;
+        unsigned int Total = 0;
+    };
+
+    DebugState s_Debug;
+
+    int SeverityRank(GLenum severity)
+    {
+        switch (severity)
+        {
+        case GL_DEBUG_SEVERITY_HIGH: return 3;
+        case GL_DEBUG_SEVERITY_MEDIUM: return 2;
+        case GL_DEBUG_SEVERITY_LOW: return 1;
+        }
+        return 0;
+    }
+
+    const char* SeverityName(GLenum severity)
+    {
+        switch (severity)
+        {
+        case GL_DEBUG_SEVERITY_HIGH: return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+        case GL_DEBUG_SEVERITY_LOW: return "low";
+        }
+        return "notification";
+    }
+
+    const char* SourceName(GLenum source)
+    {
+        switch (source)
+        {
+        case GL_DEBUG_SOURCE_API: return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "WindowSystem";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "ShaderCompiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "ThirdParty";
+        case GL_DEBUG_SOURCE_APPLICATION: return "Application";
+        }
+        return "Other";
+    }
+
+    const char* TypeName(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_DEBUG_TYPE_ERROR: return "Error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "Undefined";
+        case GL_DEBUG_TYPE_PORTABILITY: return "Portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "Performance";
+        case GL_DEBUG_TYPE_MARKER: return "Marker";
+        }
+        return "Other";
+    }
+
+    unsigned int SourceBit(GLenum source)
+    {
+        if (source < GL_DEBUG_SOURCE_API || source > GL_DEBUG_SOURCE_OTHER)
+            return GLDebugSource_Other;
+        return 1u << (source - GL_DEBUG_SOURCE_API);
+    }
+
+    void GLAPIENTRY OnDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+        GLsizei length, const GLchar* message, const void* /*userParam*/)
+    {
+        if (type == GL_DEBUG_TYPE_ERROR)
+            s_Debug.ErrorRaised = true;
+
+        // 过滤只针对其他消息，错误总是输出
+        const GLDebugConfig& config = s_Debug.Config;
+        if (type != GL_DEBUG_TYPE_ERROR
+            && (!(config.SourceMask & SourceBit(source)) || SeverityRank(severity) < SeverityRank(config.MinSeverity)))
+            return;
+
+        std::string text = length < 0 ? std::string(message) : std::string(message, length);
+
+        std::lock_guard<std::mutex> lock(s_Debug.Mutex);
+        s_Debug.Total++;
+
+        // 同一来源/类型/id/文本的消息只输出前 MaxRepeats 次
+        unsigned long long key = ((unsigned long long)id << 32)
+            ^ ((unsigned long long)(source & 0xF) << 28) ^ ((unsigned long long)(type & 0xFF) << 20)
+            ^ std::hash<std::string>()(text);
+        unsigned int& repeats = s_Debug.Repeats[key];
+        if (++repeats > config.MaxRepeats)
+        {
+            s_Debug.Suppressed++;
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - s_Debug.WindowStart >= std::chrono::seconds(1))
+        {
+            if (s_Debug.Dropped > 0)
+                std::cout << "[OpenGL Debug] " << s_Debug.Dropped << " message(s) dropped by rate limit" << std::endl;
+            s_Debug.WindowStart = now;
+            s_Debug.WindowCount = 0;
+            s_Debug.Dropped = 0;
+        }
+        if (++s_Debug.WindowCount > config.MaxMessagesPerSecond)
+        {
+            s_Debug.Dropped++;
+            return;
+        }
+
+        std::cout << "[OpenGL Debug] (" << SourceName(source) << "/" << TypeName(type) << "/"
+            << SeverityName(severity) << " #" << id << "): " << text << std::endl;
+#if GL_CHECK_LEVEL != GL_CHECK_OFF
+        std::cout << "    at " << g_GLCallSite.function << " " << g_GLCallSite.file << ":" << g_GLCallSite.line << std::endl;
+#endif
+        if (repeats == config.MaxRepeats)
+            std::cout << "    (further repeats of this message are suppressed)" << std::endl;
+    }
+}
+
+bool GLDebug::Init(const GLDebugConfig& config)
+{
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+    {
+        std::cout << "[OpenGL Debug] KHR_debug not available, falling back to glGetError" << std::endl;
+        return false;
+    }
+
+    s_Debug.Config = config;
+    s_Debug.WindowStart = std::chrono::steady_clock::now();
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if (config.Synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(OnDebugMessage, nullptr);
+
+    // 在驱动端关掉不需要的消息，避免回调本身的开销
+    const GLenum severities[] = {
+        GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH
+    };
+    for (GLenum source = GL_DEBUG_SOURCE_API; source <= GL_DEBUG_SOURCE_OTHER; source++)
+    {
+        bool sourceEnabled = (config.SourceMask & SourceBit(source)) != 0;
+        for (GLenum severity : severities)
+        {
+            bool enabled = sourceEnabled && SeverityRank(severity) >= SeverityRank(config.MinSeverity);
+            glDebugMessageControl(source, GL_DONT_CARE, severity, 0, nullptr, enabled ? GL_TRUE : GL_FALSE);
+        }
+    }
+    // 不再轮询 glGetError，错误只能靠回调报告，不受级别和来源过滤影响
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+
+    // 清掉初始化之前积压的错误，之后的检查都交给回调
+    while (glGetError() != GL_NO_ERROR);
+    s_Debug.Active = true;
+    return true;
+}
+
+void GLDebug::Shutdown()
+{
+    if (!s_Debug.Active)
+        return;
+    glDebugMessageCallback(nullptr, nullptr);
+    glDisable(GL_DEBUG_OUTPUT);
+    s_Debug.Active = false;
+}
+
+bool GLDebug::IsActive()
+{
+    return s_Debug.Active;
+}
+
+bool GLDebug::ConsumeError()
+{
+    return s_Debug.ErrorRaised.exchange(false);
+}
+
+void GLDebug::PrintSummary()
+{
+    std::lock_guard<std::mutex> lock(s_Debug.Mutex);
+    std::cout << "[OpenGL Debug] " << s_Debug.Total << " message(s), "
+        << s_Debug.Suppressed << " suppressed as duplicates, "
+        << s_Debug.Repeats.size() << " unique" << std::endl;
+}
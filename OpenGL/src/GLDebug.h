@@ -0,0 +1,38 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// 按消息来源过滤的位掩码（对应 GL_DEBUG_SOURCE_*）
+enum GLDebugSourceBits : unsigned int
+{
+    GLDebugSource_API            = 1 << 0,
+    GLDebugSource_WindowSystem   = 1 << 1,
+    GLDebugSource_ShaderCompiler = 1 << 2,
+    GLDebugSource_ThirdParty     = 1 << 3,
+    GLDebugSource_Application    = 1 << 4,
+    GLDebugSource_Other          = 1 << 5,
+    GLDebugSource_All            = 0x3F
+};
+
+struct GLDebugConfig
+{
+    GLenum MinSeverity = GL_DEBUG_SEVERITY_LOW;  // 低于该级别的消息直接在驱动端关闭，GL 错误除外
+    unsigned int SourceMask = GLDebugSource_All; // 同上，GL 错误不受影响
+    unsigned int MaxRepeats = 3;                 // 同一条消息最多输出几次
+    unsigned int MaxMessagesPerSecond = 20;      // 每秒最多输出的消息数
+    bool Synchronous = true;                     // 同步输出，才能对应到当前的 GLCall 位置
+};
+
+// 基于 KHR_debug 的调试输出，用回调代替轮询 glGetError
+class GLDebug
+{
+public:
+    // 在上下文创建并初始化 GLEW 之后调用；扩展不可用时返回 false
+    static bool Init(const GLDebugConfig& config = GLDebugConfig());
+    static void Shutdown();
+
+    static bool IsActive();
+    // 自上次调用以来是否收到过 GL_DEBUG_TYPE_ERROR 类型的消息
+    static bool ConsumeError();
+    static void PrintSummary();
+};
@@ -0,0 +1,246 @@
+#include "GLState.h"
+#include "Renderer.h"
+#include <iostream>
+#include <unordered_map>
+
+namespace
+{
+    // 未知状态（启动时或 Invalidate 之后），与任何真实值都不相等
+    const unsigned int Unknown = 0xFFFFFFFF;
+    const unsigned int MaxTextureUnits = 32;
+
+    struct TextureBinding
+    {
+        unsigned int Target;
+        unsigned int Texture;
+    };
+
+    struct ShadowState
+    {
+        unsigned int Program = Unknown;
+        unsigned int VertexArray = Unknown;
+        unsigned int ArrayBuffer = Unknown;
+        // GL_ELEMENT_ARRAY_BUFFER 的绑定属于 VAO，切换 VAO 时随之切换
+        std::unordered_map<unsigned int, unsigned int> ElementBuffers;
+        std::unordered_map<unsigned int, unsigned int> OtherBuffers;
+
+        unsigned int ActiveUnit = Unknown;
+        TextureBinding Textures[MaxTextureUnits];
+
+        unsigned int Blend = Unknown;
+        unsigned int BlendSrc = Unknown;
+        unsigned int BlendDst = Unknown;
+        unsigned int DepthTest = Unknown;
+        unsigned int DepthFunc = Unknown;
+
+        ShadowState()
+        {
+            for (TextureBinding& binding : Textures)
+                binding = { Unknown, Unknown };
+        }
+    };
+
+    ShadowState s_State;
+    GLStateStats s_Stats;
+
+    // 值相同返回 false（并计入跳过次数），否则更新缓存并返回 true
+    inline bool Change(unsigned int& cached, unsigned int value, GLStateCategory category)
+    {
+        if (cached == value)
+        {
+            s_Stats.Skipped[(int)category]++;
+            return false;
+        }
+        cached = value;
+        s_Stats.Issued[(int)category]++;
+        return true;
+    }
+
+    unsigned int& ElementBufferSlot()
+    {
+        auto it = s_State.ElementBuffers.find(s_State.VertexArray);
+        if (it == s_State.ElementBuffers.end())
+            it = s_State.ElementBuffers.emplace(s_State.VertexArray, Unknown).first;
+        return it->second;
+    }
+
+    const char* CategoryName(GLStateCategory category)
+    {
+        switch (category)
+        {
+        case GLStateCategory::Program: return "Program";
+        case GLStateCategory::VertexArray: return "VertexArray";
+        case GLStateCategory::Buffer: return "Buffer";
+        case GLStateCategory::Texture: return "Texture";
+        case GLStateCategory::Blend: return "Blend";
+        case GLStateCategory::Depth: return "Depth";
+        default: break;
+        }
+        return "Unknown";
+    }
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+    if (Change(s_State.Program, program, GLStateCategory::Program))
+    {
+        GLCall(glUseProgram(program));
+    }
+}
+
+void GLState::BindVertexArray(unsigned int vertexArray)
+{
+    if (Change(s_State.VertexArray, vertexArray, GLStateCategory::VertexArray))
+    {
+        GLCall(glBindVertexArray(vertexArray));
+    }
+}
+
+void GLState::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    unsigned int* cached;
+    if (target == GL_ARRAY_BUFFER)
+        cached = &s_State.ArrayBuffer;
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+        cached = &ElementBufferSlot();
+    else
+        cached = &s_State.OtherBuffers.emplace(target, Unknown).first->second;
+
+    if (Change(*cached, buffer, GLStateCategory::Buffer))
+    {
+        GLCall(glBindBuffer(target, buffer));
+    }
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+    ASSERT(unit < MaxTextureUnits);
+    TextureBinding& binding = s_State.Textures[unit];
+    if (binding.Target == target && binding.Texture == texture)
+    {
+        s_Stats.Skipped[(int)GLStateCategory::Texture]++;
+        return;
+    }
+    if (s_State.ActiveUnit != unit)
+    {
+        s_State.ActiveUnit = unit;
+        GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    }
+    binding = { target, texture };
+    s_Stats.Issued[(int)GLStateCategory::Texture]++;
+    GLCall(glBindTexture(target, texture));
+}
+
+void GLState::SetBlend(bool enabled)
+{
+    if (Change(s_State.Blend, enabled, GLStateCategory::Blend))
+    {
+        if (enabled)
+        {
+            GLCall(glEnable(GL_BLEND));
+        }
+        else
+        {
+            GLCall(glDisable(GL_BLEND));
+        }
+    }
+}
+
+void GLState::BlendFunc(unsigned int src, unsigned int dst)
+{
+    if (s_State.BlendSrc == src && s_State.BlendDst == dst)
+    {
+        s_Stats.Skipped[(int)GLStateCategory::Blend]++;
+        return;
+    }
+    s_State.BlendSrc = src;
+    s_State.BlendDst = dst;
+    s_Stats.Issued[(int)GLStateCategory::Blend]++;
+    GLCall(glBlendFunc(src, dst));
+}
+
+void GLState::SetDepthTest(bool enabled)
+{
+    if (Change(s_State.DepthTest, enabled, GLStateCategory::Depth))
+    {
+        if (enabled)
+        {
+            GLCall(glEnable(GL_DEPTH_TEST));
+        }
+        else
+        {
+            GLCall(glDisable(GL_DEPTH_TEST));
+        }
+    }
+}
+
+void GLState::DepthFunc(unsigned int func)
+{
+    if (Change(s_State.DepthFunc, func, GLStateCategory::Depth))
+    {
+        GLCall(glDepthFunc(func));
+    }
+}
+
+void GLState::OnProgramDeleted(unsigned int program)
+{
+    // 删除正在使用的程序不会解除绑定，它要等到切换程序后才真正释放
+    if (s_State.Program == program)
+        s_State.Program = Unknown;
+}
+
+void GLState::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+    if (s_State.VertexArray == vertexArray)
+        s_State.VertexArray = 0;
+    s_State.ElementBuffers.erase(vertexArray);
+}
+
+void GLState::OnBufferDeleted(unsigned int buffer)
+{
+    // 当前上下文中绑定的名字被删除后会回到 0；其他 VAO 里的引用状态未知
+    if (s_State.ArrayBuffer == buffer)
+        s_State.ArrayBuffer = 0;
+    for (auto& element : s_State.ElementBuffers)
+    {
+        if (element.second == buffer)
+            element.second = element.first == s_State.VertexArray ? 0 : Unknown;
+    }
+    for (auto& other : s_State.OtherBuffers)
+    {
+        if (other.second == buffer)
+            other.second = 0;
+    }
+}
+
+void GLState::OnTextureDeleted(unsigned int texture)
+{
+    for (TextureBinding& binding : s_State.Textures)
+    {
+        if (binding.Texture == texture)
+            binding.Texture = 0;
+    }
+}
+
+void GLState::Invalidate()
+{
+    s_State = ShadowState();
+}
+
+const GLStateStats& GLState::GetStats()
+{
+    return s_Stats;
+}
+
+void GLState::ResetStats()
+{
+    s_Stats = GLStateStats();
+}
+
+void GLState::PrintStats()
+{
+    std::cout << "[GLState] issued / skipped:";
+    for (int i = 0; i < (int)GLStateCategory::Count; i++)
+        std::cout << " " << CategoryName((GLStateCategory)i) << " " << s_Stats.Issued[i] << "/" << s_Stats.Skipped[i];
+    std::cout << std::endl;
+}
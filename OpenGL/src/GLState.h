@@ -0,0 +1,41 @@
+#pragma once
+
+enum class GLStateCategory
+{
+    Program, VertexArray, Buffer, Texture, Blend, Depth, Count
+};
+
+struct GLStateStats
+{
+    unsigned int Issued[(int)GLStateCategory::Count] = {};
+    unsigned int Skipped[(int)GLStateCategory::Count] = {};
+};
+
+// 影子 GL 状态：记录当前绑定的对象和开关，值没有变化时跳过对应的 GL 调用
+// 所有绑定都必须经过这里，直接调用 glBind* 之后需要调用 Invalidate()
+class GLState
+{
+public:
+    static void UseProgram(unsigned int program);
+    static void BindVertexArray(unsigned int vertexArray);
+    static void BindBuffer(unsigned int target, unsigned int buffer);
+    static void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+
+    static void SetBlend(bool enabled);
+    static void BlendFunc(unsigned int src, unsigned int dst);
+    static void SetDepthTest(bool enabled);
+    static void DepthFunc(unsigned int func);
+
+    // 删除对象时调用，避免缓存中残留已经失效的名字
+    static void OnProgramDeleted(unsigned int program);
+    static void OnVertexArrayDeleted(unsigned int vertexArray);
+    static void OnBufferDeleted(unsigned int buffer);
+    static void OnTextureDeleted(unsigned int texture);
+
+    // 忘掉所有缓存的状态，下一次设置一定会发出 GL 调用
+    static void Invalidate();
+
+    static const GLStateStats& GetStats();
+    static void ResetStats();
+    static void PrintStats();
+};
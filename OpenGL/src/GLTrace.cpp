@@ -0,0 +1,250 @@
+#include "GLTrace.h"
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    // 单生产者（所属线程）/单消费者（写文件线程）的环形缓冲区
+    struct ThreadRing
+    {
+        static constexpr uint32_t Capacity = 1 << 14;
+
+        GLTraceRecord Records[Capacity];
+        std::atomic<uint32_t> Head{ 0 };
+        std::atomic<uint32_t> Tail{ 0 };
+        uint32_t ThreadIndex = 0;
+    };
+
+    struct TraceState
+    {
+        std::ofstream File;
+        std::chrono::steady_clock::time_point Start;
+
+        // 线程注册表只在线程第一次录制时加锁；环形缓冲区在进程结束前一直保留
+        std::mutex RingsMutex;
+        std::vector<std::unique_ptr<ThreadRing>> Rings;
+
+        std::mutex BlobMutex;
+        std::unordered_set<uint64_t> BlobHashes;
+        std::vector<std::pair<uint64_t, std::string>> PendingBlobs;
+
+        std::thread Writer;
+        std::mutex WriterMutex;
+        std::condition_variable WriterWake;
+        bool WriterRunning = false;
+
+        uint64_t Calls = 0;
+        std::atomic<uint64_t> Stalls{ 0 };
+    };
+
+    TraceState s_Trace;
+    thread_local ThreadRing* t_Ring = nullptr;
+
+    ThreadRing& GetThreadRing()
+    {
+        if (!t_Ring)
+        {
+            std::lock_guard<std::mutex> lock(s_Trace.RingsMutex);
+            s_Trace.Rings.push_back(std::make_unique<ThreadRing>());
+            t_Ring = s_Trace.Rings.back().get();
+            t_Ring->ThreadIndex = (uint32_t)s_Trace.Rings.size() - 1;
+        }
+        return *t_Ring;
+    }
+
+    void WriteChunk(GLTraceChunk type, const std::vector<char>& payload)
+    {
+        GLTraceChunkHeader header = { (uint32_t)type, (uint32_t)payload.size() };
+        s_Trace.File.write((const char*)&header, sizeof(header));
+        s_Trace.File.write(payload.data(), payload.size());
+    }
+
+    template<typename T>
+    void Append(std::vector<char>& out, const T& value)
+    {
+        const char* bytes = (const char*)&value;
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteBlobs()
+    {
+        std::vector<std::pair<uint64_t, std::string>> blobs;
+        {
+            std::lock_guard<std::mutex> lock(s_Trace.BlobMutex);
+            blobs.swap(s_Trace.PendingBlobs);
+        }
+        std::vector<char> payload;
+        for (const auto& blob : blobs)
+        {
+            payload.clear();
+            Append(payload, blob.first);
+            payload.insert(payload.end(), blob.second.begin(), blob.second.end());
+            WriteChunk(GLTraceChunk::Blob, payload);
+        }
+    }
+
+    void DrainRing(ThreadRing& ring, std::vector<char>& payload)
+    {
+        uint32_t tail = ring.Tail.load(std::memory_order_relaxed);
+        uint32_t head = ring.Head.load(std::memory_order_acquire);
+        if (head == tail)
+            return;
+
+        payload.clear();
+        Append(payload, ring.ThreadIndex);
+        Append(payload, head - tail);
+        for (uint32_t i = tail; i != head; i++)
+        {
+            const GLTraceRecord& record = ring.Records[i & (ThreadRing::Capacity - 1)];
+            Append(payload, record.Header);
+            const char* args = (const char*)record.Args;
+            payload.insert(payload.end(), args, args + record.Header.ArgCount * sizeof(uint64_t));
+        }
+        ring.Tail.store(head, std::memory_order_release);
+        s_Trace.Calls += head - tail;
+        WriteChunk(GLTraceChunk::Calls, payload);
+    }
+
+    void DrainAll()
+    {
+        // 先写 blob：引用它的调用记录一定在它之后才进入环形缓冲区
+        WriteBlobs();
+        std::vector<ThreadRing*> rings;
+        {
+            std::lock_guard<std::mutex> lock(s_Trace.RingsMutex);
+            for (auto& ring : s_Trace.Rings)
+                rings.push_back(ring.get());
+        }
+        std::vector<char> payload;
+        for (ThreadRing* ring : rings)
+            DrainRing(*ring, payload);
+    }
+
+    void WriterLoop()
+    {
+        std::unique_lock<std::mutex> lock(s_Trace.WriterMutex);
+        while (s_Trace.WriterRunning)
+        {
+            s_Trace.WriterWake.wait_for(lock, std::chrono::milliseconds(5));
+            lock.unlock();
+            DrainAll();
+            lock.lock();
+        }
+        lock.unlock();
+        DrainAll();
+    }
+}
+
+bool GLTrace::Start(const std::string& filepath)
+{
+    if (IsRecording())
+        return false;
+#ifndef GL_TRACE
+    std::cout << "[GLTrace] built without GL_TRACE, no GL calls will be recorded" << std::endl;
+#endif
+
+    s_Trace.File.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!s_Trace.File)
+    {
+        std::cout << "[GLTrace] cannot open " << filepath << std::endl;
+        return false;
+    }
+
+    GLTraceFileHeader header = { GLTRACE_MAGIC, GLTRACE_VERSION,
+        (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() };
+    s_Trace.File.write((const char*)&header, sizeof(header));
+
+    uint16_t funcCount = (uint16_t)GLTraceFunc::Count;
+    s_Trace.File.write((const char*)&funcCount, sizeof(funcCount));
+    for (uint16_t i = 0; i < funcCount; i++)
+    {
+        const char* name = GLTraceFuncName((GLTraceFunc)i);
+        uint8_t length = (uint8_t)std::strlen(name);
+        s_Trace.File.write((const char*)&length, sizeof(length));
+        s_Trace.File.write(name, length);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_Trace.RingsMutex);
+        for (auto& ring : s_Trace.Rings)
+            ring->Tail.store(ring->Head.load());
+    }
+    s_Trace.BlobHashes.clear();
+    s_Trace.PendingBlobs.clear();
+    s_Trace.Calls = 0;
+    s_Trace.Stalls = 0;
+    s_Trace.Start = std::chrono::steady_clock::now();
+
+    s_Trace.WriterRunning = true;
+    s_Trace.Writer = std::thread(WriterLoop);
+    s_Recording = true;
+    return true;
+}
+
+void GLTrace::Stop()
+{
+    if (!IsRecording())
+        return;
+    s_Recording = false;
+    {
+        std::lock_guard<std::mutex> lock(s_Trace.WriterMutex);
+        s_Trace.WriterRunning = false;
+    }
+    s_Trace.WriterWake.notify_one();
+    s_Trace.Writer.join();
+    s_Trace.File.close();
+
+    std::cout << "[GLTrace] recorded " << s_Trace.Calls << " calls, "
+        << s_Trace.Stalls << " ring buffer stalls" << std::endl;
+}
+
+void GLTrace::FrameEnd()
+{
+    if (!IsRecording())
+        return;
+    GLTraceCall call(GLTraceFunc::FrameEnd);
+    call.Begin();
+    call.End();
+    s_Trace.WriterWake.notify_one();
+}
+
+uint64_t GLTrace::Now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - s_Trace.Start).count();
+}
+
+void GLTrace::Push(const GLTraceRecord& record)
+{
+    ThreadRing& ring = GetThreadRing();
+    uint32_t head = ring.Head.load(std::memory_order_relaxed);
+    if (head - ring.Tail.load(std::memory_order_acquire) >= ThreadRing::Capacity)
+    {
+        // 缓冲区满了：唤醒写文件线程并等待它腾出空间，不丢记录
+        s_Trace.Stalls++;
+        while (head - ring.Tail.load(std::memory_order_acquire) >= ThreadRing::Capacity)
+        {
+            s_Trace.WriterWake.notify_one();
+            std::this_thread::yield();
+        }
+    }
+    ring.Records[head & (ThreadRing::Capacity - 1)] = record;
+    ring.Head.store(head + 1, std::memory_order_release);
+}
+
+uint64_t GLTrace::Blob(const void* data, size_t size)
+{
+    uint64_t hash = GLTraceHash(data, size);
+    std::lock_guard<std::mutex> lock(s_Trace.BlobMutex);
+    if (s_Trace.BlobHashes.insert(hash).second)
+        s_Trace.PendingBlobs.emplace_back(hash, std::string((const char*)data, size));
+    return hash;
+}
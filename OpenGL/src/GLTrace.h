@@ -0,0 +1,515 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include "GLTraceFormat.h"
+
+// GL 调用录制器：每个线程写自己的无锁环形缓冲区，后台线程把它们写入二进制追踪文件
+class GLTrace
+{
+public:
+    static bool Start(const std::string& filepath);
+    static void Stop();
+    static void FrameEnd();
+
+    static bool IsRecording() { return s_Recording.load(std::memory_order_relaxed); }
+
+    static uint64_t Now();
+    static void Push(const GLTraceRecord& record);
+    // 记录一段数据（如着色器源码），回放时可以按哈希取回；返回其哈希
+    static uint64_t Blob(const void* data, size_t size);
+
+private:
+    inline static std::atomic<bool> s_Recording{ false };
+};
+
+class GLTraceCall
+{
+private:
+    GLTraceRecord m_Record;
+    uint64_t m_Start;
+public:
+    explicit GLTraceCall(GLTraceFunc func) : m_Start(0)
+    {
+        m_Record.Header = { (uint16_t)func, 0, 0, 0, 0 };
+    }
+
+    template<typename T>
+    GLTraceCall& Arg(T value)
+    {
+        if (m_Record.Header.ArgCount == GLTRACE_MAX_ARGS)
+            return *this;
+        uint64_t bits = 0;
+        if constexpr (std::is_pointer_v<T>)
+            bits = (uint64_t)(uintptr_t)value;
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            float f = (float)value;
+            uint32_t u;
+            std::memcpy(&u, &f, sizeof(u));
+            bits = u;
+        }
+        else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+            bits = (uint64_t)(int64_t)value;
+        m_Record.Args[m_Record.Header.ArgCount++] = bits;
+        return *this;
+    }
+
+    GLTraceCall& Hash(uint64_t hash)
+    {
+        if (m_Record.Header.ArgCount < GLTRACE_MAX_ARGS)
+            m_Record.Header.HashMask |= (uint8_t)(1u << m_Record.Header.ArgCount);
+        return Arg(hash);
+    }
+
+    // 参数放不下时把整个名字数组写成 blob，只记录它的哈希（HashMask 中对应位为 1）
+    GLTraceCall& Names(GLsizei n, const GLuint* names)
+    {
+        if (n > GLTRACE_MAX_ARGS - m_Record.Header.ArgCount)
+            return Hash(GLTrace::Blob(names, (size_t)n * sizeof(GLuint)));
+        for (GLsizei i = 0; i < n; i++)
+            Arg(names[i]);
+        return *this;
+    }
+
+    void Begin() { m_Start = GLTrace::Now(); }
+
+    void End()
+    {
+        uint64_t now = GLTrace::Now();
+        m_Record.Header.TimestampNs = m_Start;
+        m_Record.Header.DurationNs = (uint32_t)(now - m_Start);
+        GLTrace::Push(m_Record);
+    }
+};
+
+#ifdef GL_TRACE
+
+// 以下包装函数替换被追踪的 GL 函数名，未录制时直接转发
+#define GLTRACE_WRAP(name, func) \
+    template<typename... A> \
+    inline auto GLTrace_##name(A... a) \
+    { \
+        if (!GLTrace::IsRecording()) \
+            return name(a...); \
+        GLTraceCall call(GLTraceFunc::func); \
+        (call.Arg(a), ...); \
+        call.Begin(); \
+        if constexpr (std::is_void_v<decltype(name(a...))>) \
+        { \
+            name(a...); \
+            call.End(); \
+        } \
+        else \
+        { \
+            auto result = name(a...); \
+            call.Arg(result).End(); \
+            return result; \
+        } \
+    }
+
+// glGen*/glDelete*：记录数量和名字数组的内容
+#define GLTRACE_WRAP_NAMES(name, func) \
+    template<typename P> \
+    inline void GLTrace_##name(GLsizei n, P names) \
+    { \
+        if (!GLTrace::IsRecording()) \
+        { \
+            name(n, names); \
+            return; \
+        } \
+        GLTraceCall call(GLTraceFunc::func); \
+        call.Begin(); \
+        name(n, names); \
+        call.Arg(n).Names(n, names).End(); \
+    }
+
+GLTRACE_WRAP(glClear, Clear)
+GLTRACE_WRAP(glClearColor, ClearColor)
+GLTRACE_WRAP(glViewport, Viewport)
+GLTRACE_WRAP(glEnable, Enable)
+GLTRACE_WRAP(glDisable, Disable)
+GLTRACE_WRAP(glBlendFunc, BlendFunc)
+GLTRACE_WRAP(glDepthFunc, DepthFunc)
+GLTRACE_WRAP_NAMES(glGenBuffers, GenBuffers)
+GLTRACE_WRAP_NAMES(glDeleteBuffers, DeleteBuffers)
+GLTRACE_WRAP(glBindBuffer, BindBuffer)
+GLTRACE_WRAP_NAMES(glGenVertexArrays, GenVertexArrays)
+GLTRACE_WRAP_NAMES(glDeleteVertexArrays, DeleteVertexArrays)
+GLTRACE_WRAP(glBindVertexArray, BindVertexArray)
+GLTRACE_WRAP(glEnableVertexAttribArray, EnableVertexAttribArray)
+GLTRACE_WRAP(glVertexAttribPointer, VertexAttribPointer)
+GLTRACE_WRAP(glCreateShader, CreateShader)
+GLTRACE_WRAP(glCompileShader, CompileShader)
+GLTRACE_WRAP(glDeleteShader, DeleteShader)
+GLTRACE_WRAP(glCreateProgram, CreateProgram)
+GLTRACE_WRAP(glAttachShader, AttachShader)
+GLTRACE_WRAP(glLinkProgram, LinkProgram)
+GLTRACE_WRAP(glValidateProgram, ValidateProgram)
+GLTRACE_WRAP(glDeleteProgram, DeleteProgram)
+GLTRACE_WRAP(glUseProgram, UseProgram)
+GLTRACE_WRAP(glUniform1i, Uniform1i)
+GLTRACE_WRAP(glUniform1f, Uniform1f)
+GLTRACE_WRAP(glUniform4f, Uniform4f)
+GLTRACE_WRAP_NAMES(glGenTextures, GenTextures)
+GLTRACE_WRAP_NAMES(glDeleteTextures, DeleteTextures)
+GLTRACE_WRAP(glBindTexture, BindTexture)
+GLTRACE_WRAP(glActiveTexture, ActiveTexture)
+GLTRACE_WRAP(glDrawArrays, DrawArrays)
+GLTRACE_WRAP(glDrawElements, DrawElements)
+GLTRACE_WRAP(glVertexAttribDivisor, VertexAttribDivisor)
+GLTRACE_WRAP(glDrawElementsInstanced, DrawElementsInstanced)
+GLTRACE_WRAP(glDrawElementsBaseVertex, DrawElementsBaseVertex)
+// 映射写入的内容无法录制，回放时用零数据填充刷新的范围
+GLTRACE_WRAP(glMapBufferRange, MapBufferRange)
+GLTRACE_WRAP(glFlushMappedBufferRange, FlushMappedBufferRange)
+GLTRACE_WRAP(glUnmapBuffer, UnmapBuffer)
+GLTRACE_WRAP(glMapNamedBufferRange, MapNamedBufferRange)
+GLTRACE_WRAP(glFlushMappedNamedBufferRange, FlushMappedNamedBufferRange)
+GLTRACE_WRAP(glUnmapNamedBuffer, UnmapNamedBuffer)
+// 同步对象按指针值记录，回放时映射为新的同步对象
+GLTRACE_WRAP(glFenceSync, FenceSync)
+GLTRACE_WRAP(glClientWaitSync, ClientWaitSync)
+GLTRACE_WRAP(glDeleteSync, DeleteSync)
+GLTRACE_WRAP(glTexParameteri, TexParameteri)
+GLTRACE_WRAP(glDrawElementsInstancedBaseVertex, DrawElementsInstancedBaseVertex)
+GLTRACE_WRAP_NAMES(glCreateBuffers, CreateBuffers)
+GLTRACE_WRAP_NAMES(glCreateVertexArrays, CreateVertexArrays)
+GLTRACE_WRAP(glEnableVertexArrayAttrib, EnableVertexArrayAttrib)
+GLTRACE_WRAP(glVertexArrayAttribFormat, VertexArrayAttribFormat)
+GLTRACE_WRAP(glVertexArrayAttribBinding, VertexArrayAttribBinding)
+GLTRACE_WRAP(glVertexArrayVertexBuffer, VertexArrayVertexBuffer)
+GLTRACE_WRAP(glVertexArrayBindingDivisor, VertexArrayBindingDivisor)
+GLTRACE_WRAP(glBindVertexBuffer, BindVertexBuffer)
+GLTRACE_WRAP(glVertexAttribFormat, VertexAttribFormat)
+GLTRACE_WRAP(glVertexAttribBinding, VertexAttribBinding)
+GLTRACE_WRAP(glVertexBindingDivisor, VertexBindingDivisor)
+
+// 缓冲区内容只记录哈希
+inline void GLTrace_glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glBufferData(target, size, data, usage);
+        return;
+    }
+    GLTraceCall call(GLTraceFunc::BufferData);
+    call.Arg(target).Arg(size).Hash(data ? GLTraceHash(data, size) : 0).Arg(usage);
+    call.Begin();
+    glBufferData(target, size, data, usage);
+    call.End();
+}
+
+inline void GLTrace_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glBufferSubData(target, offset, size, data);
+        return;
+    }
+    GLTraceCall call(GLTraceFunc::BufferSubData);
+    call.Arg(target).Arg(offset).Arg(size).Hash(GLTraceHash(data, size));
+    call.Begin();
+    glBufferSubData(target, offset, size, data);
+    call.End();
+}
+
+inline void GLTrace_glBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glBufferStorage(target, size, data, flags);
+        return;
+    }
+    GLTraceCall call(GLTraceFunc::BufferStorage);
+    call.Arg(target).Arg(size).Hash(data ? GLTraceHash(data, size) : 0).Arg(flags);
+    call.Begin();
+    glBufferStorage(target, size, data, flags);
+    call.End();
+}
+
+// 按默认的 GL_UNPACK_ALIGNMENT（4）计算像素数据的字节数
+inline size_t GLTraceImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+{
+    size_t components = 4;
+    switch (format)
+    {
+    case GL_RED: case GL_GREEN: case GL_BLUE: case GL_ALPHA: case GL_RED_INTEGER:
+    case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+        components = 1;
+        break;
+    case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL:
+        components = 2;
+        break;
+    case GL_RGB: case GL_BGR: case GL_RGB_INTEGER:
+        components = 3;
+        break;
+    }
+    size_t pixel;
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE: case GL_BYTE:
+        pixel = components;
+        break;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+        pixel = components * 2;
+        break;
+    case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+        pixel = components * 4;
+        break;
+    case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1:
+        pixel = 2;
+        break;
+    default: // 8_8_8_8、10_10_10_2、24_8 等打包格式
+        pixel = 4;
+        break;
+    }
+    size_t row = ((size_t)width * pixel + 3) & ~(size_t)3;
+    return row * (size_t)height;
+}
+
+// border 在核心模式下只能为 0，它的位置记录像素数据的字节数（没有数据时为 0）
+inline void GLTrace_glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+    GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+        return;
+    }
+    GLTraceCall call(GLTraceFunc::TexImage2D);
+    call.Arg(target).Arg(level).Arg(internalFormat).Arg(width).Arg(height)
+        .Arg(pixels ? GLTraceImageSize(width, height, format, type) : 0).Arg(format).Arg(type);
+    call.Begin();
+    glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+    call.End();
+}
+
+inline void GLTrace_glNamedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glNamedBufferData(buffer, size, data, usage);
+        return;
+    }
+    GLTraceCall call(GLTraceFunc::NamedBufferData);
+    call.Arg(buffer).Arg(size).Hash(data ? GLTraceHash(data, size) : 0).Arg(usage);
+    call.Begin();
+    glNamedBufferData(buffer, size, data, usage);
+    call.End();
+}
+
+inline void GLTrace_glNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glNamedBufferSubData(buffer, offset, size, data);
+        return;
+    }
+    GLTraceCall call(GLTraceFunc::NamedBufferSubData);
+    call.Arg(buffer).Arg(offset).Arg(size).Hash(GLTraceHash(data, size));
+    call.Begin();
+    glNamedBufferSubData(buffer, offset, size, data);
+    call.End();
+}
+
+inline void GLTrace_glNamedBufferStorage(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glNamedBufferStorage(buffer, size, data, flags);
+        return;
+    }
+    GLTraceCall call(GLTraceFunc::NamedBufferStorage);
+    call.Arg(buffer).Arg(size).Hash(data ? GLTraceHash(data, size) : 0).Arg(flags);
+    call.Begin();
+    glNamedBufferStorage(buffer, size, data, flags);
+    call.End();
+}
+
+inline void GLTrace_glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glUniformMatrix4fv(location, count, transpose, value);
+        return;
+    }
+    GLTraceCall call(GLTraceFunc::UniformMatrix4fv);
+    call.Arg(location).Arg(count).Arg(transpose).Hash(GLTraceHash(value, count * 16 * sizeof(GLfloat)));
+    call.Begin();
+    glUniformMatrix4fv(location, count, transpose, value);
+    call.End();
+}
+
+// 着色器源码和 uniform 名字以 blob 形式写入文件，回放时才能重新编译/查询
+inline void GLTrace_glShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+    if (!GLTrace::IsRecording())
+    {
+        glShaderSource(shader, count, strings, lengths);
+        return;
+    }
+    std::string source;
+    for (GLsizei i = 0; i < count; i++)
+        source.append(strings[i], lengths && lengths[i] >= 0 ? (size_t)lengths[i] : std::strlen(strings[i]));
+    GLTraceCall call(GLTraceFunc::ShaderSource);
+    call.Arg(shader).Hash(GLTrace::Blob(source.data(), source.size()));
+    call.Begin();
+    glShaderSource(shader, count, strings, lengths);
+    call.End();
+}
+
+inline GLint GLTrace_glGetUniformLocation(GLuint program, const GLchar* name)
+{
+    if (!GLTrace::IsRecording())
+        return glGetUniformLocation(program, name);
+    GLTraceCall call(GLTraceFunc::GetUniformLocation);
+    call.Arg(program).Hash(GLTrace::Blob(name, std::strlen(name)));
+    call.Begin();
+    GLint location = glGetUniformLocation(program, name);
+    call.Arg(location).End();
+    return location;
+}
+
+#undef glClear
+#undef glClearColor
+#undef glViewport
+#undef glEnable
+#undef glDisable
+#undef glBlendFunc
+#undef glDepthFunc
+#undef glGenBuffers
+#undef glDeleteBuffers
+#undef glBindBuffer
+#undef glBufferData
+#undef glBufferSubData
+#undef glGenVertexArrays
+#undef glDeleteVertexArrays
+#undef glBindVertexArray
+#undef glEnableVertexAttribArray
+#undef glVertexAttribPointer
+#undef glCreateShader
+#undef glShaderSource
+#undef glCompileShader
+#undef glDeleteShader
+#undef glCreateProgram
+#undef glAttachShader
+#undef glLinkProgram
+#undef glValidateProgram
+#undef glDeleteProgram
+#undef glUseProgram
+#undef glGetUniformLocation
+#undef glUniform1i
+#undef glUniform1f
+#undef glUniform4f
+#undef glUniformMatrix4fv
+#undef glGenTextures
+#undef glDeleteTextures
+#undef glBindTexture
+#undef glActiveTexture
+#undef glDrawArrays
+#undef glDrawElements
+#undef glVertexAttribDivisor
+#undef glDrawElementsInstanced
+#undef glDrawElementsBaseVertex
+#undef glBufferStorage
+#undef glMapBufferRange
+#undef glFlushMappedBufferRange
+#undef glUnmapBuffer
+#undef glFenceSync
+#undef glClientWaitSync
+#undef glDeleteSync
+#undef glTexImage2D
+#undef glTexParameteri
+#undef glDrawElementsInstancedBaseVertex
+#undef glCreateBuffers
+#undef glNamedBufferData
+#undef glNamedBufferSubData
+#undef glNamedBufferStorage
+#undef glCreateVertexArrays
+#undef glEnableVertexArrayAttrib
+#undef glVertexArrayAttribFormat
+#undef glVertexArrayAttribBinding
+#undef glVertexArrayVertexBuffer
+#undef glVertexArrayBindingDivisor
+#undef glMapNamedBufferRange
+#undef glFlushMappedNamedBufferRange
+#undef glUnmapNamedBuffer
+#undef glBindVertexBuffer
+#undef glVertexAttribFormat
+#undef glVertexAttribBinding
+#undef glVertexBindingDivisor
+
+#define glClear GLTrace_glClear
+#define glClearColor GLTrace_glClearColor
+#define glViewport GLTrace_glViewport
+#define glEnable GLTrace_glEnable
+#define glDisable GLTrace_glDisable
+#define glBlendFunc GLTrace_glBlendFunc
+#define glDepthFunc GLTrace_glDepthFunc
+#define glGenBuffers GLTrace_glGenBuffers
+#define glDeleteBuffers GLTrace_glDeleteBuffers
+#define glBindBuffer GLTrace_glBindBuffer
+#define glBufferData GLTrace_glBufferData
+#define glBufferSubData GLTrace_glBufferSubData
+#define glGenVertexArrays GLTrace_glGenVertexArrays
+#define glDeleteVertexArrays GLTrace_glDeleteVertexArrays
+#define glBindVertexArray GLTrace_glBindVertexArray
+#define glEnableVertexAttribArray GLTrace_glEnableVertexAttribArray
+#define glVertexAttribPointer GLTrace_glVertexAttribPointer
+#define glCreateShader GLTrace_glCreateShader
+#define glShaderSource GLTrace_glShaderSource
+#define glCompileShader GLTrace_glCompileShader
+#define glDeleteShader GLTrace_glDeleteShader
+#define glCreateProgram GLTrace_glCreateProgram
+#define glAttachShader GLTrace_glAttachShader
+#define glLinkProgram GLTrace_glLinkProgram
+#define glValidateProgram GLTrace_glValidateProgram
+#define glDeleteProgram GLTrace_glDeleteProgram
+#define glUseProgram GLTrace_glUseProgram
+#define glGetUniformLocation GLTrace_glGetUniformLocation
+#define glUniform1i GLTrace_glUniform1i
+#define glUniform1f GLTrace_glUniform1f
+#define glUniform4f GLTrace_glUniform4f
+#define glUniformMatrix4fv GLTrace_glUniformMatrix4fv
+#define glGenTextures GLTrace_glGenTextures
+#define glDeleteTextures GLTrace_glDeleteTextures
+#define glBindTexture GLTrace_glBindTexture
+#define glActiveTexture GLTrace_glActiveTexture
+#define glDrawArrays GLTrace_glDrawArrays
+#define glDrawElements GLTrace_glDrawElements
+#define glVertexAttribDivisor GLTrace_glVertexAttribDivisor
+#define glDrawElementsInstanced GLTrace_glDrawElementsInstanced
+#define glDrawElementsBaseVertex GLTrace_glDrawElementsBaseVertex
+#define glBufferStorage GLTrace_glBufferStorage
+#define glMapBufferRange GLTrace_glMapBufferRange
+#define glFlushMappedBufferRange GLTrace_glFlushMappedBufferRange
+#define glUnmapBuffer GLTrace_glUnmapBuffer
+#define glFenceSync GLTrace_glFenceSync
+#define glClientWaitSync GLTrace_glClientWaitSync
+#define glDeleteSync GLTrace_glDeleteSync
+#define glTexImage2D GLTrace_glTexImage2D
+#define glTexParameteri GLTrace_glTexParameteri
+#define glDrawElementsInstancedBaseVertex GLTrace_glDrawElementsInstancedBaseVertex
+#define glCreateBuffers GLTrace_glCreateBuffers
+#define glNamedBufferData GLTrace_glNamedBufferData
+#define glNamedBufferSubData GLTrace_glNamedBufferSubData
+#define glNamedBufferStorage GLTrace_glNamedBufferStorage
+#define glCreateVertexArrays GLTrace_glCreateVertexArrays
+#define glEnableVertexArrayAttrib GLTrace_glEnableVertexArrayAttrib
+#define glVertexArrayAttribFormat GLTrace_glVertexArrayAttribFormat
+#define glVertexArrayAttribBinding GLTrace_glVertexArrayAttribBinding
+#define glVertexArrayVertexBuffer GLTrace_glVertexArrayVertexBuffer
+#define glVertexArrayBindingDivisor GLTrace_glVertexArrayBindingDivisor
+#define glMapNamedBufferRange GLTrace_glMapNamedBufferRange
+#define glFlushMappedNamedBufferRange GLTrace_glFlushMappedNamedBufferRange
+#define glUnmapNamedBuffer GLTrace_glUnmapNamedBuffer
+#define glBindVertexBuffer GLTrace_glBindVertexBuffer
+#define glVertexAttribFormat GLTrace_glVertexAttribFormat
+#define glVertexAttribBinding GLTrace_glVertexAttribBinding
+#define glVertexBindingDivisor GLTrace_glVertexBindingDivisor
+
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// GL 调用追踪文件格式（录制端 GLTrace 和回放端 GLReplay 共用）
+//
+// 文件 = GLTraceFileHeader + 函数名表 + 若干 Chunk
+// 函数名表：uint16 数量，之后每项为 uint8 长度 + 名字
+// Chunk：GLTraceChunkHeader + Size 字节的内容
+//   Calls：uint32 线程序号 + uint32 记录数 + 压缩记录（GLTraceRecordHeader + ArgCount 个 uint64）
+//   Blob ：uint64 哈希 + 数据（着色器源码、uniform 名字、放不进参数的 GLuint 名字数组等）
+
+#define GLTRACE_MAGIC 0x52544C47u // "GLTR"
+// 版本 2：glGen*/glDelete* 的名字放不进参数时整个数组存为 Blob（版本 1 只保留前 7 个）
+#define GLTRACE_VERSION 2u
+#define GLTRACE_MIN_VERSION 1u // 回放端仍能读取的最旧版本
+#define GLTRACE_MAX_ARGS 8
+
+// 被追踪的函数列表，编号写入文件，只能在末尾追加
+#define GLTRACE_FUNCTIONS(X) \
+    X(FrameEnd) \
+    X(Clear) X(ClearColor) X(Viewport) X(Enable) X(Disable) X(BlendFunc) X(DepthFunc) \
+    X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BufferData) X(BufferSubData) \
+    X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray) \
+    X(EnableVertexAttribArray) X(VertexAttribPointer) \
+    X(CreateShader) X(ShaderSource) X(CompileShader) X(DeleteShader) \
+    X(CreateProgram) X(AttachShader) X(LinkProgram) X(ValidateProgram) X(DeleteProgram) X(UseProgram) \
+    X(GetUniformLocation) X(Uniform1i) X(Uniform1f) X(Uniform4f) X(UniformMatrix4fv) \
+    X(GenTextures) X(DeleteTextures) X(BindTexture) X(ActiveTexture) \
+    X(DrawArrays) X(DrawElements) \
+    X(VertexAttribDivisor) X(DrawElementsInstanced) X(DrawElementsBaseVertex) \
+    X(BufferStorage) X(MapBufferRange) X(FlushMappedBufferRange) X(UnmapBuffer) \
+    X(FenceSync) X(ClientWaitSync) X(DeleteSync) \
+    X(TexImage2D) X(TexParameteri) \
+    X(DrawElementsInstancedBaseVertex) \
+    X(CreateBuffers) X(NamedBufferData) X(NamedBufferSubData) X(NamedBufferStorage) \
+    X(CreateVertexArrays) X(EnableVertexArrayAttrib) X(VertexArrayAttribFormat) X(VertexArrayAttribBinding) \
+    X(VertexArrayVertexBuffer) X(VertexArrayBindingDivisor) \
+    X(MapNamedBufferRange) X(FlushMappedNamedBufferRange) X(UnmapNamedBuffer) \
+    X(BindVertexBuffer) X(VertexAttribFormat) X(VertexAttribBinding) X(VertexBindingDivisor)
+
+enum class GLTraceFunc : uint16_t
+{
+#define GLTRACE_ENUM(name) name,
+    GLTRACE_FUNCTIONS(GLTRACE_ENUM)
+#undef GLTRACE_ENUM
+    Count
+};
+
+inline const char* GLTraceFuncName(GLTraceFunc func)
+{
+    static const char* names[] = {
+#define GLTRACE_NAME(name) #name,
+        GLTRACE_FUNCTIONS(GLTRACE_NAME)
+#undef GLTRACE_NAME
+    };
+    return func < GLTraceFunc::Count ? names[(size_t)func] : "Unknown";
+}
+
+enum class GLTraceChunk : uint32_t
+{
+    Calls = 1,
+    Blob = 2
+};
+
+#pragma pack(push, 1)
+struct GLTraceFileHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t StartTimeNs; // 录制开始时间（system_clock，纳秒）
+};
+
+struct GLTraceChunkHeader
+{
+    uint32_t Type;
+    uint32_t Size;
+};
+
+struct GLTraceRecordHeader
+{
+    uint16_t Func;
+    uint8_t ArgCount;
+    uint8_t HashMask;     // 第 i 位为 1 表示第 i 个参数是数据哈希
+    uint32_t DurationNs;
+    uint64_t TimestampNs; // 相对录制开始
+};
+#pragma pack(pop)
+
+struct GLTraceRecord
+{
+    GLTraceRecordHeader Header;
+    uint64_t Args[GLTRACE_MAX_ARGS];
+};
+
+// FNV-1a，用于缓冲区内容和 blob 的哈希
+inline uint64_t GLTraceHash(const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
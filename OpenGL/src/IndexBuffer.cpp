@@ -1,27 +1,156 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "BufferPool.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include <algorithm>
+#include <iostream>
 
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count): m_Count(count)
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, BufferUsage usage)
+    : IndexBuffer(Pack(data, count), count, usage)
+{
+}
+
+IndexBuffer::IndexBuffer(BufferPool& pool, const unsigned int* data, unsigned int count, BufferUsage usage)
+    : IndexBuffer(pool, Pack(data, count), count, usage)
+{
+}
+
+IndexBuffer::IndexBuffer(const PackedIndices& packed, unsigned int count, BufferUsage usage)
+    : Buffer(GL_ELEMENT_ARRAY_BUFFER, packed.Data, count * GetSizeOfType(packed.Type), usage),
+      m_Count(count), m_Type(packed.Type)
+{
+}
+
+IndexBuffer::IndexBuffer(BufferPool& pool, const PackedIndices& packed, unsigned int count, BufferUsage usage)
+    : Buffer(pool, packed.Data, count * GetSizeOfType(packed.Type), GetSizeOfType(packed.Type), usage),
+      m_Count(count), m_Type(packed.Type)
+{
+}
+
+unsigned int IndexBuffer::GetSizeOfType(unsigned int type)
+{
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE:  return 1;
+    case GL_UNSIGNED_SHORT: return 2;
+    case GL_UNSIGNED_INT:   return 4;
+    }
+    ASSERT(false);
+    return 0;
+}
+
+unsigned int IndexBuffer::ChooseType(const unsigned int* data, unsigned int count)
+{
+    unsigned int maxIndex = 0;
+    for (unsigned int i = 0; i < count; i++)
+        maxIndex = data[i] > maxIndex ? data[i] : maxIndex;
+
+    if (maxIndex <= 0xFF)
+        return GL_UNSIGNED_BYTE;
+    if (maxIndex <= 0xFFFF)
+        return GL_UNSIGNED_SHORT;
+    return GL_UNSIGNED_INT;
+}
+
+IndexBuffer::PackedIndices IndexBuffer::Pack(const unsigned int* data, unsigned int count, unsigned int type)
 {
     ASSERT(sizeof(GLuint) == sizeof(unsigned int));
 
-    GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, GL_STATIC_DRAW));
+    PackedIndices packed;
+    packed.Type = type != 0 ? type : (data ? ChooseType(data, count) : GL_UNSIGNED_INT);
+    packed.Data = data;
+    if (!data || packed.Type == GL_UNSIGNED_INT)
+        return packed;
+
+    packed.Storage.resize(count * GetSizeOfType(packed.Type));
+    if (packed.Type == GL_UNSIGNED_SHORT)
+    {
+        unsigned short* indices = (unsigned short*)packed.Storage.data();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            ASSERT(data[i] <= 0xFFFF);
+            indices[i] = (unsigned short)data[i];
+        }
+    }
+    else
+    {
+        unsigned char* indices = packed.Storage.data();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            ASSERT(data[i] <= 0xFF);
+            indices[i] = (unsigned char)data[i];
+        }
+    }
+    packed.Data = packed.Storage.data();
+    return packed;
 }
 
-IndexBuffer::~IndexBuffer()
+void IndexBuffer::SetData(const unsigned int* data, unsigned int count)
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
+    // 池中的区间大小固定，只能沿用原来的类型
+    if (m_Pool && data && GetSizeOfType(ChooseType(data, count)) > GetIndexSize())
+    {
+        std::cout << "[IndexBuffer] index does not fit the pooled " << GetIndexSize() * 8 << "-bit type, update ignored" << std::endl;
+        return;
+    }
+    PackedIndices packed = Pack(data, count, m_Pool ? m_Type : 0);
+    Buffer::SetData(packed.Data, count * GetSizeOfType(packed.Type));
+    m_Count = count;
+    m_Type = packed.Type;
 }
 
-void IndexBuffer::Bind() const
+void IndexBuffer::SetSubData(const unsigned int* data, unsigned int first, unsigned int count)
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+    ASSERT(first + count <= m_Count);
+    if (GetSizeOfType(ChooseType(data, count)) > GetIndexSize())
+    {
+        if (m_Pool)
+        {
+            std::cout << "[IndexBuffer] index does not fit the pooled " << GetIndexSize() * 8 << "-bit type, update ignored" << std::endl;
+            return;
+        }
+        std::vector<unsigned int> indices = ReadIndices();
+        std::copy(data, data + count, indices.begin() + first);
+        SetData(indices.data(), m_Count);
+        return;
+    }
+    PackedIndices packed = Pack(data, count, m_Type);
+    Buffer::SetSubData(packed.Data, first * GetIndexSize(), count * GetIndexSize());
 }
 
-void IndexBuffer::Unbind() const
+std::vector<unsigned int> IndexBuffer::ReadIndices() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    unsigned int size = m_Count * GetIndexSize();
+    std::vector<unsigned char> bytes;
+    if (m_Shadow.size() >= size)
+    {
+        bytes.assign(m_Shadow.begin(), m_Shadow.begin() + size);
+    }
+    else
+    {
+        bytes.resize(size);
+        if (GLCaps::HasDirectStateAccess())
+        {
+            GLCall(glGetNamedBufferSubData(m_RendererID, m_Offset, size, bytes.data()));
+        }
+        else
+        {
+            GLState::BindBuffer(m_Target, m_RendererID);
+            GLCall(glGetBufferSubData(m_Target, m_Offset, size, bytes.data()));
+        }
+    }
+
+    std::vector<unsigned int> indices(m_Count);
+    for (unsigned int i = 0; i < m_Count; i++)
+    {
+        if (m_Type == GL_UNSIGNED_BYTE)
+            indices[i] = bytes[i];
+        else if (m_Type == GL_UNSIGNED_SHORT)
+            indices[i] = ((const unsigned short*)bytes.data())[i];
+        else
+            indices[i] = ((const unsigned int*)bytes.data())[i];
+    }
+    return indices;
 }
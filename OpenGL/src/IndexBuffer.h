@@ -1,16 +1,47 @@
 #pragma once
-class IndexBuffer
+
+#include <vector>
+#include "Buffer.h"
+
+// 根据最大索引自动选择 GL_UNSIGNED_BYTE / GL_UNSIGNED_SHORT / GL_UNSIGNED_INT 存储，
+// 绘制时用 GetType() 作为 glDrawElements 的 type
+class IndexBuffer : public Buffer
 {
 private:
-    unsigned int m_RendererID;
+    struct PackedIndices
+    {
+        unsigned int Type;
+        const void* Data;                  // 指向 Storage，或者类型为 GL_UNSIGNED_INT 时直接指向原数据
+        std::vector<unsigned char> Storage;
+    };
+
     unsigned int m_Count;
+    unsigned int m_Type;
 public:
-    IndexBuffer(const unsigned int* data,unsigned int count);
-    ~IndexBuffer();
+    IndexBuffer(const unsigned int* data, unsigned int count, BufferUsage usage = BufferUsage::Static);
+    // 从 pool 中分配，绘制时以 GetOffset() 作为索引的字节偏移
+    IndexBuffer(BufferPool& pool, const unsigned int* data, unsigned int count, BufferUsage usage = BufferUsage::Static);
 
-    void Bind() const;
-    void Unbind() const;
+    // 以索引个数为单位，覆盖 Buffer 中按字节计算的版本。
+    // SetData 会重新选择类型；SetSubData 的索引超出当前类型时取回全部索引，换成更宽的类型重新上传。
+    // 池中的缓冲不能改变类型，超出范围的更新会打印错误并被忽略
+    void SetData(const unsigned int* data, unsigned int count);
+    void SetSubData(const unsigned int* data, unsigned int first, unsigned int count);
 
     inline unsigned int GetCount() const { return m_Count; }
-};
+    inline unsigned int GetType() const { return m_Type; }
+    inline unsigned int GetIndexSize() const { return GetSizeOfType(m_Type); }
 
+    // 能容纳 data 中最大索引的最小类型
+    static unsigned int ChooseType(const unsigned int* data, unsigned int count);
+    static unsigned int GetSizeOfType(unsigned int type);
+private:
+    IndexBuffer(const PackedIndices& packed, unsigned int count, BufferUsage usage);
+    IndexBuffer(BufferPool& pool, const PackedIndices& packed, unsigned int count, BufferUsage usage);
+
+    // 当前的全部索引，优先从 CPU 副本读取，Static 缓冲从 GPU 取回
+    std::vector<unsigned int> ReadIndices() const;
+
+    // type 为 0 时自动选择
+    static PackedIndices Pack(const unsigned int* data, unsigned int count, unsigned int type = 0);
+};
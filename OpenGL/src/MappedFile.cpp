@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : m_Data(nullptr), m_Size(0), m_Open(false)
+{
+}
+
+// 映射建立后视图自己持有文件，句柄可以立即关闭
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& filepath) : MappedFile()
+{
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size))
+    {
+        m_Open = true;
+        // 长度为 0 的文件不能创建映射
+        if (size.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping)
+            {
+                m_Data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+            }
+            if (m_Data)
+                m_Size = (size_t)size.QuadPart;
+            else
+                m_Open = false;
+        }
+    }
+    CloseHandle(file);
+}
+
+void MappedFile::Release()
+{
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+}
+#else
+MappedFile::MappedFile(const std::string& filepath) : MappedFile()
+{
+    int file = open(filepath.c_str(), O_RDONLY);
+    if (file < 0)
+        return;
+    struct stat info;
+    if (fstat(file, &info) == 0)
+    {
+        m_Open = true;
+        // 长度为 0 的文件不能映射
+        if (info.st_size > 0)
+        {
+            void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+                m_Data = (const char*)data;
+                m_Size = (size_t)info.st_size;
+            }
+            else
+            {
+                m_Open = false;
+            }
+        }
+    }
+    close(file);
+}
+
+void MappedFile::Release()
+{
+    if (m_Data)
+        munmap((void*)m_Data, m_Size);
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+    Release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)),
+      m_Open(std::exchange(other.m_Open, false))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0);
+        m_Open = std::exchange(other.m_Open, false);
+    }
+    return *this;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 只读内存映射的文件，内容直接由页缓存提供，不复制到堆上。只能移动；
+// 空文件或打不开的文件得到空的视图，用 IsOpen 区分两者
+class MappedFile
+{
+private:
+    const char* m_Data;
+    size_t m_Size;
+    bool m_Open;
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filepath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    inline bool IsOpen() const { return m_Open; }
+    inline std::string_view GetView() const { return { m_Data, m_Size }; }
+private:
+    void Release();
+};
@@ -0,0 +1,351 @@
+#include "MeshOptimizer.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    const unsigned int Invalid = 0xFFFFFFFF;
+
+    struct Cluster
+    {
+        unsigned int Begin; // 三角形下标
+        unsigned int End;
+        float Potential;    // 遮挡其他簇的可能性，越大越先画
+    };
+}
+
+void MeshOptimizer::Tipsify(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize,
+    std::vector<unsigned int>& output, std::vector<unsigned int>* clusters)
+{
+    // Sander 等人的 Tipsify：围绕一个“扇心”顶点输出它所有未输出的三角形，
+    // 再从刚输出的顶点里选一个仍在缓存中、剩余三角形又不多的作为下一个扇心
+    unsigned int triangleCount = indexCount / 3;
+    output.clear();
+    output.reserve(indexCount);
+    if (clusters)
+        clusters->clear();
+    if (triangleCount == 0)
+        return;
+
+    // 顶点 -> 三角形的邻接表（CSR），live 为每个顶点尚未输出的三角形数
+    std::vector<unsigned int> live(vertexCount, 0);
+    for (unsigned int i = 0; i < indexCount; i++)
+        live[indices[i]]++;
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; v++)
+        offsets[v + 1] = offsets[v] + live[v];
+    std::vector<unsigned int> adjacency(indexCount);
+    std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+    for (unsigned int i = 0; i < indexCount; i++)
+        adjacency[cursor[indices[i]]++] = i / 3;
+
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    unsigned int timestamp = cacheSize + 1;
+    unsigned int scan = 0;
+    unsigned int fanning = indices[0];
+    bool newCluster = true;
+
+    while (fanning != Invalid)
+    {
+        candidates.clear();
+        for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+        {
+            unsigned int triangle = adjacency[a];
+            if (emitted[triangle])
+                continue;
+            if (newCluster && clusters)
+                clusters->push_back((unsigned int)output.size() / 3);
+            newCluster = false;
+
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                unsigned int v = indices[triangle * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (timestamp - cacheTime[v] > cacheSize)
+                    cacheTime[v] = timestamp++;
+            }
+            emitted[triangle] = true;
+        }
+
+        // 优先选在缓存里待得最久、但输出完剩余三角形后仍不会被挤出缓存的顶点
+        unsigned int next = Invalid;
+        int best = -1;
+        for (unsigned int v : candidates)
+        {
+            if (live[v] == 0)
+                continue;
+            int priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize)
+                priority = (int)(timestamp - cacheTime[v]);
+            if (priority > best)
+            {
+                best = priority;
+                next = v;
+            }
+        }
+
+        // 死路：先回溯最近输出过的顶点，再按输入顺序找下一个还有三角形的顶点
+        while (next == Invalid && !deadEnd.empty())
+        {
+            unsigned int v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0)
+                next = v;
+        }
+        while (next == Invalid && scan < indexCount)
+        {
+            unsigned int v = indices[scan++];
+            if (live[v] > 0)
+            {
+                // 跳到网格中不相邻的位置，之前的缓存内容不再有用，作为簇的硬边界
+                next = v;
+                newCluster = true;
+            }
+        }
+        fanning = next;
+    }
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize)
+{
+    std::vector<unsigned int> output;
+    Tipsify(indices, indexCount, vertexCount, cacheSize, output, nullptr);
+    std::memcpy(indices, output.data(), output.size() * sizeof(unsigned int));
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const float* positions,
+    unsigned int vertexCount, unsigned int positionStride, float threshold, unsigned int cacheSize)
+{
+    unsigned int triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    std::vector<unsigned int> ordered;
+    std::vector<unsigned int> hardBoundaries;
+    Tipsify(indices, indexCount, vertexCount, cacheSize, ordered, &hardBoundaries);
+    hardBoundaries.push_back(triangleCount);
+    float targetACMR = AnalyzeVertexCache(ordered.data(), indexCount, vertexCount, cacheSize).ACMR;
+
+    // 软边界：在硬簇内模拟一个冷缓存，簇的 ACMR 已经降到 threshold * 整体 ACMR 以下时就切开，
+    // 这样重排簇只会让每个簇开头多几次未命中
+    std::vector<Cluster> clusters;
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    unsigned int timestamp = cacheSize + 1;
+    for (unsigned int h = 0; h + 1 < hardBoundaries.size(); h++)
+    {
+        unsigned int begin = hardBoundaries[h];
+        unsigned int misses = 0;
+        timestamp += cacheSize + 1;
+        for (unsigned int t = begin; t < hardBoundaries[h + 1]; t++)
+        {
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                unsigned int v = ordered[t * 3 + k];
+                if (timestamp - cacheTime[v] > cacheSize)
+                {
+                    cacheTime[v] = timestamp++;
+                    misses++;
+                }
+            }
+            bool last = t + 1 == hardBoundaries[h + 1];
+            if (last || (float)misses / (float)(t + 1 - begin) <= threshold * targetACMR)
+            {
+                clusters.push_back({ begin, t + 1, 0.0f });
+                begin = t + 1;
+                misses = 0;
+                timestamp += cacheSize + 1;
+            }
+        }
+    }
+
+    auto position = [&](unsigned int v) { return (const float*)((const unsigned char*)positions + (size_t)v * positionStride); };
+
+    // 整个网格的面积加权中心
+    float meshCenter[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    std::vector<float> triangleData(triangleCount * 7); // 面积加权法线(3) + 中心(3) + 面积
+    for (unsigned int t = 0; t < triangleCount; t++)
+    {
+        const float* p0 = position(ordered[t * 3 + 0]);
+        const float* p1 = position(ordered[t * 3 + 1]);
+        const float* p2 = position(ordered[t * 3 + 2]);
+        float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        float* data = &triangleData[t * 7];
+        data[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        data[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        data[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        float area = std::sqrt(data[0] * data[0] + data[1] * data[1] + data[2] * data[2]) * 0.5f;
+        for (int i = 0; i < 3; i++)
+        {
+            data[3 + i] = (p0[i] + p1[i] + p2[i]) / 3.0f;
+            meshCenter[i] += data[3 + i] * area;
+        }
+        data[6] = area;
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+    {
+        for (float& c : meshCenter)
+            c /= meshArea;
+    }
+
+    // 遮挡势：簇中心相对网格中心的位移在簇法线上的投影，朝外且靠外的簇更可能挡住其他簇
+    for (Cluster& cluster : clusters)
+    {
+        float normal[3] = { 0.0f, 0.0f, 0.0f };
+        float center[3] = { 0.0f, 0.0f, 0.0f };
+        float area = 0.0f;
+        for (unsigned int t = cluster.Begin; t < cluster.End; t++)
+        {
+            const float* data = &triangleData[t * 7];
+            for (int i = 0; i < 3; i++)
+            {
+                normal[i] += data[i];
+                center[i] += data[3 + i] * data[6];
+            }
+            area += data[6];
+        }
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (area <= 0.0f || length <= 0.0f)
+            continue;
+        for (int i = 0; i < 3; i++)
+            cluster.Potential += (center[i] / area - meshCenter[i]) * normal[i] / length;
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+        [](const Cluster& a, const Cluster& b) { return a.Potential > b.Potential; });
+
+    unsigned int* out = indices;
+    for (const Cluster& cluster : clusters)
+    {
+        unsigned int count = (cluster.End - cluster.Begin) * 3;
+        std::memcpy(out, &ordered[cluster.Begin * 3], count * sizeof(unsigned int));
+        out += count;
+    }
+}
+
+unsigned int MeshOptimizer::OptimizeVertexFetch(void* vertices, unsigned int vertexSize, unsigned int vertexCount,
+    unsigned int* indices, unsigned int indexCount)
+{
+    std::vector<unsigned int> remap(vertexCount, Invalid);
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+    {
+        unsigned int& index = indices[i];
+        ASSERT(index < vertexCount);
+        if (remap[index] == Invalid)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    unsigned char* data = (unsigned char*)vertices;
+    std::vector<unsigned char> original(data, data + (size_t)vertexCount * vertexSize);
+    for (unsigned int v = 0; v < vertexCount; v++)
+    {
+        if (remap[v] != Invalid)
+            std::memcpy(data + (size_t)remap[v] * vertexSize, &original[(size_t)v * vertexSize], vertexSize);
+    }
+    return next;
+}
+
+MeshOptimizeReport MeshOptimizer::Optimize(void* vertices, unsigned int vertexSize, unsigned int& vertexCount,
+    unsigned int* indices, unsigned int indexCount, unsigned int positionOffset, unsigned int cacheSize)
+{
+    MeshOptimizeReport report;
+    report.CacheBefore = AnalyzeVertexCache(indices, indexCount, vertexCount, cacheSize);
+    report.FetchBefore = AnalyzeVertexFetch(indices, indexCount, vertexCount, vertexSize, cacheSize);
+
+    const float* positions = (const float*)((const unsigned char*)vertices + positionOffset);
+    OptimizeOverdraw(indices, indexCount, positions, vertexCount, vertexSize, 1.05f, cacheSize);
+    vertexCount = OptimizeVertexFetch(vertices, vertexSize, vertexCount, indices, indexCount);
+
+    report.CacheAfter = AnalyzeVertexCache(indices, indexCount, vertexCount, cacheSize);
+    report.FetchAfter = AnalyzeVertexFetch(indices, indexCount, vertexCount, vertexSize, cacheSize);
+    return report;
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+    unsigned int cacheSize)
+{
+    // FIFO 缓存：命中不会刷新位置，与大多数硬件的变换后缓存一致
+    VertexCacheStats stats;
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    unsigned int timestamp = cacheSize + 1;
+    unsigned int unique = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+    {
+        unsigned int v = indices[i];
+        if (timestamp - cacheTime[v] > cacheSize)
+        {
+            cacheTime[v] = timestamp++;
+            stats.Misses++;
+        }
+        if (!referenced[v])
+        {
+            referenced[v] = true;
+            unique++;
+        }
+    }
+    if (indexCount >= 3)
+        stats.ACMR = (float)stats.Misses / (float)(indexCount / 3);
+    if (unique > 0)
+        stats.ATVR = (float)stats.Misses / (float)unique;
+    return stats;
+}
+
+VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+    unsigned int vertexSize, unsigned int cacheSize)
+{
+    // 只有变换缓存未命中的顶点才需要读取，读取以缓存行为单位，缓存行同样按 FIFO 替换
+    VertexFetchStats stats;
+    unsigned int lineCount = (unsigned int)(((unsigned long long)vertexCount * vertexSize + FetchCacheLineSize - 1) / FetchCacheLineSize);
+    std::vector<unsigned int> lineTime(lineCount, 0);
+    std::vector<unsigned int> vertexTime(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    unsigned int lineStamp = FetchCacheLines + 1;
+    unsigned int vertexStamp = cacheSize + 1;
+    unsigned int unique = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+    {
+        unsigned int v = indices[i];
+        if (!referenced[v])
+        {
+            referenced[v] = true;
+            unique++;
+        }
+        if (vertexStamp - vertexTime[v] <= cacheSize)
+            continue;
+        vertexTime[v] = vertexStamp++;
+
+        unsigned long long begin = (unsigned long long)v * vertexSize;
+        for (unsigned long long line = begin / FetchCacheLineSize; line <= (begin + vertexSize - 1) / FetchCacheLineSize; line++)
+        {
+            if (lineStamp - lineTime[line] > FetchCacheLines)
+            {
+                lineTime[line] = lineStamp++;
+                stats.BytesFetched += FetchCacheLineSize;
+            }
+        }
+    }
+    if (unique > 0)
+        stats.Overfetch = (float)stats.BytesFetched / (float)((unsigned long long)unique * vertexSize);
+    return stats;
+}
+
+void MeshOptimizer::PrintReport(const MeshOptimizeReport& report)
+{
+    std::cout << "[MeshOptimizer] ACMR " << report.CacheBefore.ACMR << " -> " << report.CacheAfter.ACMR
+        << ", ATVR " << report.CacheBefore.ATVR << " -> " << report.CacheAfter.ATVR
+        << ", overfetch " << report.FetchBefore.Overfetch << " -> " << report.FetchAfter.Overfetch << std::endl;
+}
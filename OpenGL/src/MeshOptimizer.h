@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+struct VertexCacheStats
+{
+    unsigned int Misses = 0;
+    float ACMR = 0.0f; // 每个三角形的平均缓存未命中数，理想值接近 0.5
+    float ATVR = 0.0f; // 未命中数 / 顶点数，理想值为 1
+};
+
+struct VertexFetchStats
+{
+    unsigned long long BytesFetched = 0;
+    float Overfetch = 0.0f; // 实际读取字节 / 被引用顶点的总字节，理想值为 1
+};
+
+struct MeshOptimizeReport
+{
+    VertexCacheStats CacheBefore;
+    VertexCacheStats CacheAfter;
+    VertexFetchStats FetchBefore;
+    VertexFetchStats FetchAfter;
+};
+
+// 在上传前对网格做离线优化：
+// 1. OptimizeVertexCache：Tipsify 三角形重排，提高变换后顶点缓存的命中率
+// 2. OptimizeOverdraw：在 Tipsify 的基础上把三角形分簇，朝外、靠外的簇先画，减少过度绘制
+// 3. OptimizeVertexFetch：按索引中首次出现的顺序重排顶点数据，让顶点读取尽量顺序访问
+// 统计函数用软件模拟的 FIFO 顶点缓存和按缓存行读取的顶点获取来评估效果
+class MeshOptimizer
+{
+public:
+    static const unsigned int DefaultCacheSize = 16;
+    static const unsigned int FetchCacheLineSize = 64;
+    static const unsigned int FetchCacheLines = 32;
+
+    static void OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+        unsigned int cacheSize = DefaultCacheSize);
+    // positions 指向第一个顶点的 xyz，相邻顶点相隔 positionStride 字节；
+    // threshold 控制分簇粒度，越大簇越小、排序越自由，但顶点缓存命中率下降越多
+    static void OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const float* positions,
+        unsigned int vertexCount, unsigned int positionStride, float threshold = 1.05f, unsigned int cacheSize = DefaultCacheSize);
+    // 原地重排 vertices 并改写 indices，去掉未被引用的顶点，返回新的顶点数
+    static unsigned int OptimizeVertexFetch(void* vertices, unsigned int vertexSize, unsigned int vertexCount,
+        unsigned int* indices, unsigned int indexCount);
+
+    // 依次执行以上三步；positionOffset 为顶点中 xyz 的字节偏移，vertexCount 会被更新
+    static MeshOptimizeReport Optimize(void* vertices, unsigned int vertexSize, unsigned int& vertexCount,
+        unsigned int* indices, unsigned int indexCount, unsigned int positionOffset = 0, unsigned int cacheSize = DefaultCacheSize);
+
+    static VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+        unsigned int cacheSize = DefaultCacheSize);
+    static VertexFetchStats AnalyzeVertexFetch(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+        unsigned int vertexSize, unsigned int cacheSize = DefaultCacheSize);
+    static void PrintReport(const MeshOptimizeReport& report);
+private:
+    // clusters 不为空时输出每个簇起始三角形的下标
+    static void Tipsify(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize,
+        std::vector<unsigned int>& output, std::vector<unsigned int>* clusters);
+};
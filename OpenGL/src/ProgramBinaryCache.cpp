@@ -0,0 +1,350 @@
+#include "ProgramBinaryCache.h"
+#include "Renderer.h"
+#include "GLCaps.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const uint32_t EntryMagic = 0x4E424750u; // "PGBN"
+    const uint32_t IndexMagic = 0x49424750u; // "PGBI"
+    const uint32_t FormatVersion = 1;
+
+#pragma pack(push, 1)
+    struct EntryHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t Key;
+        uint32_t Format; // glGetProgramBinary 返回的 binaryFormat
+        uint32_t Size;
+        uint64_t Hash;   // 二进制内容的 FNV-1a
+    };
+
+    struct IndexHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t Count;
+        uint64_t Clock;
+    };
+
+    struct IndexEntry
+    {
+        uint64_t Key;
+        uint64_t Bytes;   // 整个文件的大小
+        uint64_t LastUse; // 越大越新
+    };
+#pragma pack(pop)
+
+    struct CacheState
+    {
+        bool Enabled = false;
+        bool Dirty = false;
+        fs::path Directory;
+        unsigned long long MaxBytes = 0;
+        unsigned long long TotalBytes = 0;
+        uint64_t Clock = 0;
+        uint64_t DriverHash = 0;
+        std::vector<GLint> Formats;
+        std::unordered_map<uint64_t, IndexEntry> Entries;
+    };
+
+    CacheState s_Cache;
+    ProgramBinaryCacheStats s_Stats;
+
+    uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    fs::path EntryPath(uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return s_Cache.Directory / name;
+    }
+
+    fs::path IndexPath()
+    {
+        return s_Cache.Directory / "index.bin";
+    }
+
+    void RemoveEntry(uint64_t key)
+    {
+        auto it = s_Cache.Entries.find(key);
+        if (it != s_Cache.Entries.end())
+        {
+            s_Cache.TotalBytes -= it->second.Bytes;
+            s_Cache.Entries.erase(it);
+        }
+        std::error_code error;
+        fs::remove(EntryPath(key), error);
+        s_Cache.Dirty = true;
+    }
+
+    void Touch(IndexEntry& entry)
+    {
+        entry.LastUse = ++s_Cache.Clock;
+        s_Cache.Dirty = true;
+    }
+
+    bool ReadIndex()
+    {
+        std::error_code error;
+        uintmax_t size = fs::file_size(IndexPath(), error);
+        std::ifstream stream(IndexPath(), std::ios::binary);
+        IndexHeader header;
+        if (error || !stream.read((char*)&header, sizeof(header)) || header.Magic != IndexMagic || header.Version != FormatVersion
+            || size != sizeof(header) + (uintmax_t)header.Count * sizeof(IndexEntry))
+            return false;
+
+        std::vector<IndexEntry> entries(header.Count);
+        if (!stream.read((char*)entries.data(), entries.size() * sizeof(IndexEntry)))
+            return false;
+
+        // 文件丢失或大小对不上的项直接丢弃，文件内容在 Load 时再校验
+        s_Cache.Clock = header.Clock;
+        for (const IndexEntry& entry : entries)
+        {
+            uintmax_t bytes = fs::file_size(EntryPath(entry.Key), error);
+            if (error || bytes != entry.Bytes)
+            {
+                s_Cache.Dirty = true;
+                continue;
+            }
+            s_Cache.Entries[entry.Key] = entry;
+            s_Cache.TotalBytes += entry.Bytes;
+        }
+        return true;
+    }
+
+    // 没有可用的索引时只读每个文件的头部重建，使用时间全部视为最旧
+    void RebuildIndex()
+    {
+        s_Cache.Entries.clear();
+        s_Cache.TotalBytes = 0;
+        s_Cache.Clock = 0;
+        s_Cache.Dirty = true;
+
+        std::error_code error;
+        for (const fs::directory_entry& file : fs::directory_iterator(s_Cache.Directory, error))
+        {
+            if (file.path().extension() != ".bin" || file.path().filename() == "index.bin")
+                continue;
+            std::ifstream stream(file.path(), std::ios::binary);
+            EntryHeader header;
+            uintmax_t bytes = file.file_size(error);
+            if (error || !stream.read((char*)&header, sizeof(header)) || header.Magic != EntryMagic
+                || header.Version != FormatVersion || bytes != sizeof(header) + header.Size || file.path() != EntryPath(header.Key))
+            {
+                stream.close();
+                fs::remove(file.path(), error);
+                continue;
+            }
+            s_Cache.Entries[header.Key] = { header.Key, bytes, 0 };
+            s_Cache.TotalBytes += bytes;
+        }
+    }
+
+    void WriteIndex()
+    {
+        std::vector<IndexEntry> entries;
+        entries.reserve(s_Cache.Entries.size());
+        for (const auto& pair : s_Cache.Entries)
+            entries.push_back(pair.second);
+
+        IndexHeader header = { IndexMagic, FormatVersion, (uint32_t)entries.size(), s_Cache.Clock };
+        std::ofstream stream(IndexPath(), std::ios::binary | std::ios::trunc);
+        stream.write((const char*)&header, sizeof(header));
+        stream.write((const char*)entries.data(), entries.size() * sizeof(IndexEntry));
+        if (stream)
+            s_Cache.Dirty = false;
+    }
+
+    void Evict()
+    {
+        while (s_Cache.TotalBytes > s_Cache.MaxBytes && !s_Cache.Entries.empty())
+        {
+            auto oldest = std::min_element(s_Cache.Entries.begin(), s_Cache.Entries.end(),
+                [](const auto& a, const auto& b) { return a.second.LastUse < b.second.LastUse; });
+            RemoveEntry(oldest->first);
+            s_Stats.Evictions++;
+        }
+    }
+}
+
+bool ProgramBinaryCache::Init(const std::string& directory, unsigned long long maxBytes)
+{
+    s_Cache = CacheState();
+    if (!GLCaps::Get().ProgramBinary)
+        return false;
+
+    std::error_code error;
+    s_Cache.Directory = directory;
+    fs::create_directories(s_Cache.Directory, error);
+    if (error)
+    {
+        std::cout << "[ProgramBinaryCache] cannot create " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    s_Cache.MaxBytes = maxBytes;
+
+    // 驱动拒绝不认识的格式时会产生 GL 错误，先取出支持的格式列表，加载前检查
+    GLint count = 0;
+    GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count));
+    s_Cache.Formats.resize(count);
+    GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, s_Cache.Formats.data()));
+
+    uint64_t driver = Hash(nullptr, 0);
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        GLCall(const char* value = (const char*)glGetString(name));
+        if (value)
+            driver = Hash(value, std::strlen(value), driver);
+    }
+    s_Cache.DriverHash = driver;
+
+    if (!ReadIndex())
+        RebuildIndex();
+    Evict();
+    s_Cache.Enabled = true;
+    return true;
+}
+
+void ProgramBinaryCache::Shutdown()
+{
+    if (s_Cache.Enabled && s_Cache.Dirty)
+        WriteIndex();
+    s_Cache.Enabled = false;
+}
+
+unsigned long long ProgramBinaryCache::MakeKey(const std::vector<std::string_view>& sources, std::string_view defines)
+{
+    uint64_t hash = Hash(&s_Cache.DriverHash, sizeof(s_Cache.DriverHash));
+    for (std::string_view source : sources)
+    {
+        // 混入长度，避免不同的切分方式得到同一个键
+        uint64_t length = source.size();
+        hash = Hash(&length, sizeof(length), hash);
+        hash = Hash(source.data(), source.size(), hash);
+    }
+    return Hash(defines.data(), defines.size(), hash);
+}
+
+unsigned int ProgramBinaryCache::Load(unsigned long long key)
+{
+    if (!s_Cache.Enabled || GLTrace::IsRecording())
+        return 0;
+
+    auto it = s_Cache.Entries.find(key);
+    if (it == s_Cache.Entries.end())
+    {
+        s_Stats.Misses++;
+        return 0;
+    }
+
+    std::ifstream stream(EntryPath(key), std::ios::binary);
+    EntryHeader header;
+    std::vector<unsigned char> binary;
+    bool valid = stream.read((char*)&header, sizeof(header)) && header.Magic == EntryMagic
+        && header.Version == FormatVersion && header.Key == key && sizeof(header) + header.Size == it->second.Bytes
+        && std::find(s_Cache.Formats.begin(), s_Cache.Formats.end(), (GLint)header.Format) != s_Cache.Formats.end();
+    if (valid)
+    {
+        binary.resize(header.Size);
+        valid = stream.read((char*)binary.data(), binary.size()) && Hash(binary.data(), binary.size()) == header.Hash;
+    }
+    stream.close();
+    if (!valid)
+    {
+        RemoveEntry(key);
+        s_Stats.Rejected++;
+        return 0;
+    }
+
+    // 驱动更新后可能不再接受旧的二进制，这时不产生 GL 错误，只是链接状态为 false
+    GLCall(unsigned int program = glCreateProgram());
+    GLCall(glProgramBinary(program, header.Format, binary.data(), (GLsizei)binary.size()));
+    GLint status = GL_FALSE;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &status));
+    if (status != GL_TRUE)
+    {
+        GLCall(glDeleteProgram(program));
+        RemoveEntry(key);
+        s_Stats.Rejected++;
+        return 0;
+    }
+
+    Touch(it->second);
+    s_Stats.Hits++;
+    return program;
+}
+
+void ProgramBinaryCache::Store(unsigned long long key, unsigned int program)
+{
+    if (!s_Cache.Enabled || GLTrace::IsRecording())
+        return;
+
+    GLint length = 0;
+    GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+    std::vector<unsigned char> binary(length);
+    GLenum format = 0;
+    GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+    binary.resize(length);
+
+    EntryHeader header = { EntryMagic, FormatVersion, key, format, (uint32_t)binary.size(), Hash(binary.data(), binary.size()) };
+    {
+        std::ofstream stream(EntryPath(key), std::ios::binary | std::ios::trunc);
+        stream.write((const char*)&header, sizeof(header));
+        stream.write((const char*)binary.data(), binary.size());
+        if (!stream)
+        {
+            stream.close();
+            RemoveEntry(key);
+            return;
+        }
+    }
+
+    auto it = s_Cache.Entries.find(key);
+    if (it != s_Cache.Entries.end())
+        s_Cache.TotalBytes -= it->second.Bytes;
+    IndexEntry& entry = s_Cache.Entries[key];
+    entry = { key, sizeof(header) + binary.size(), 0 };
+    s_Cache.TotalBytes += entry.Bytes;
+    Touch(entry);
+    s_Stats.Stores++;
+    Evict();
+}
+
+bool ProgramBinaryCache::IsEnabled()
+{
+    return s_Cache.Enabled;
+}
+
+const ProgramBinaryCacheStats& ProgramBinaryCache::GetStats()
+{
+    return s_Stats;
+}
+
+void ProgramBinaryCache::PrintStats()
+{
+    std::cout << "[ProgramBinaryCache] " << s_Stats.Hits << " hits, " << s_Stats.Misses << " misses, "
+        << s_Stats.Rejected << " rejected, " << s_Stats.Stores << " stored, " << s_Stats.Evictions << " evicted; "
+        << s_Cache.Entries.size() << " entries, " << s_Cache.TotalBytes / 1024 << " KB" << std::endl;
+}
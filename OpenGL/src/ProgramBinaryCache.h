@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct ProgramBinaryCacheStats
+{
+    unsigned int Hits = 0;
+    unsigned int Misses = 0;
+    unsigned int Rejected = 0;  // 文件损坏或驱动拒绝加载的二进制
+    unsigned int Stores = 0;
+    unsigned int Evictions = 0;
+};
+
+// 磁盘上的程序二进制缓存：链接成功的程序用 glGetProgramBinary 取出，按键写入目录中的单独文件，
+// 下次启动时用 glProgramBinary 直接加载，跳过编译和链接。
+// 目录中的 index.bin 记录每一项的大小和最近使用时间，总大小超过上限时淘汰最久未用的项；
+// 索引缺失或损坏时扫描目录重建。每个文件带哈希，读取时校验，不通过就删除并当作未命中
+class ProgramBinaryCache
+{
+public:
+    static const unsigned long long DefaultMaxBytes = 64ull * 1024 * 1024;
+
+    // 在 GLCaps::Init 之后调用；驱动不支持程序二进制时返回 false，之后的 Load / Store 都不做任何事
+    static bool Init(const std::string& directory, unsigned long long maxBytes = DefaultMaxBytes);
+    // 写回索引
+    static void Shutdown();
+
+    // 键混合了所有阶段的预处理后源码、宏定义以及 GL_VENDOR / GL_RENDERER / GL_VERSION，
+    // 换驱动后旧的项自然不再命中，之后被淘汰
+    static unsigned long long MakeKey(const std::vector<std::string_view>& sources, std::string_view defines);
+
+    // 命中时新建程序并加载二进制，返回程序名；未命中或驱动拒绝时返回 0，调用方从源码编译。
+    // 录制 GL 追踪时总是返回 0，回放需要完整的编译调用
+    static unsigned int Load(unsigned long long key);
+    // program 必须已经链接成功，且链接前设置了 GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    static void Store(unsigned long long key, unsigned int program);
+
+    static bool IsEnabled();
+    static const ProgramBinaryCacheStats& GetStats();
+    static void PrintStats();
+};
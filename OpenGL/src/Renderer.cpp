@@ -1,17 +1,231 @@
 #include "Renderer.h"
+#include "GLDebug.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "VertexBuffer.h"
+#include "Shader.h"
+#include "ResourceManager.h"
 #include <iostream>
 
+GLCallSite g_GLCallSite = { "<none>", "<none>", 0 };
+
 void GLClearError()
 {
+    // 调试回调启用后，错误由回调报告，不再轮询 glGetError
+    if (GLDebug::IsActive())
+        return;
     while (glGetError() != GL_NO_ERROR);
 }
 
 bool GLLogCall(const char* function, const char* file, int line)
 {
+    if (GLDebug::IsActive())
+        return !GLDebug::ConsumeError();
     while (GLenum error = glGetError())
     {
         std::cout << "[OpenGL Error] (" << error << "): " << function << " " << file << ":" << line << std::endl;
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+bool GLCheckErrors()
+{
+    if (GLDebug::IsActive())
+        return !GLDebug::ConsumeError();
+    bool ok = true;
+    while (GLenum error = glGetError())
+    {
+        std::cout << "[OpenGL Error] (" << error << "): after " << g_GLCallSite.function
+            << " " << g_GLCallSite.file << ":" << g_GLCallSite.line << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+void Renderer::Clear() const
+{
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+}
+
+void Renderer::DrawElements(unsigned int count, unsigned int type, unsigned int offset, unsigned int instanceCount, int baseVertex)
+{
+    const void* indices = (const void*)(uintptr_t)offset;
+    if (baseVertex == 0)
+    {
+        if (instanceCount == 1)
+        {
+            GLCall(glDrawElements(GL_TRIANGLES, count, type, indices));
+        }
+        else
+        {
+            GLCall(glDrawElementsInstanced(GL_TRIANGLES, count, type, indices, instanceCount));
+        }
+    }
+    else
+    {
+        if (instanceCount == 1)
+        {
+            GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, count, type, (void*)indices, baseVertex));
+        }
+        else
+        {
+            GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, type, indices, instanceCount, baseVertex));
+        }
+    }
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, int baseVertex) const
+{
+    DrawInstanced(va, ib, shader, 1, baseVertex);
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount, int baseVertex) const
+{
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+    DrawElements(ib.GetCount(), ib.GetType(), ib.GetOffset(), instanceCount, baseVertex);
+}
+
+void Renderer::Draw(const VertexArray& format, const VertexBuffer& vb, const IndexBuffer& ib, const Shader& shader) const
+{
+    shader.Bind();
+    format.Bind();
+    format.BindVertexBuffer(0, vb);
+    ib.Bind();
+    DrawElements(ib.GetCount(), ib.GetType(), ib.GetOffset(), 1, 0);
+}
+
+void Renderer::Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const UniformSet& uniforms, float depth, int baseVertex)
+{
+    SubmitInstanced(va, ib, shader, 1, uniforms, depth, baseVertex);
+}
+
+void Renderer::Submit(const VertexArray& format, const VertexBuffer& vb, const IndexBuffer& ib, Shader& shader,
+    const UniformSet& uniforms, float depth)
+{
+    SubmitInstanced(format, ib, shader, 1, uniforms, depth, 0);
+    m_Commands.back().VB = &vb;
+}
+
+bool Renderer::Submit(ResourceManager& resources, Handle<VertexArray> va, Handle<IndexBuffer> ib, Handle<Shader> shader,
+    const UniformSet& uniforms, float depth, int baseVertex)
+{
+    const VertexArray* vertexArray = resources.Get(va);
+    const IndexBuffer* indexBuffer = resources.Get(ib);
+    Shader* program = resources.Get(shader);
+    if (!vertexArray || !indexBuffer || !program)
+        return false;
+    SubmitInstanced(*vertexArray, *indexBuffer, *program, 1, uniforms, depth, baseVertex);
+    // SlotMap 删除和插入都会移动对象，指针不能留到 Flush
+    DrawCommand& command = m_Commands.back();
+    command.VA = nullptr;
+    command.IB = nullptr;
+    command.Program = nullptr;
+    command.Resources = &resources;
+    command.VAHandle = va;
+    command.IBHandle = ib;
+    command.ProgramHandle = shader;
+    return true;
+}
+
+void Renderer::SubmitInstanced(const VertexArray& va, const IndexBuffer& ib, Shader& shader, unsigned int instanceCount,
+    const UniformSet& uniforms, float depth, int baseVertex)
+{
+    unsigned long long material = uniforms.Hash();
+
+    // 键从高到低：程序(16) | VAO(16) | 材质(16) | 深度(16)
+    unsigned long long depthBits = (unsigned long long)((depth < 0.0f ? 0.0f : depth > 1.0f ? 1.0f : depth) * 65535.0f);
+    unsigned long long key = ((unsigned long long)(shader.GetRendererID() & 0xFFFF) << 48)
+        | ((unsigned long long)(va.GetRendererID() & 0xFFFF) << 32)
+        | (((material ^ (material >> 16) ^ (material >> 32) ^ (material >> 48)) & 0xFFFF) << 16)
+        | depthBits;
+
+    m_SortItems.push_back({ key, (unsigned int)m_Commands.size() });
+    const std::vector<UniformValue>& values = uniforms.GetValues();
+    m_Commands.push_back({ &va, nullptr, &ib, &shader, (unsigned int)m_Uniforms.size(), (unsigned int)values.size(),
+        instanceCount, baseVertex, material, nullptr, {}, {}, {} });
+    m_Uniforms.insert(m_Uniforms.end(), values.begin(), values.end());
+    m_Stats.Submitted++;
+}
+
+void Renderer::Flush()
+{
+    RadixSort(m_SortItems, m_SortScratch);
+
+    const Shader* lastProgram = nullptr;
+    unsigned long long lastMaterial = 0;
+    for (const SortItem& item : m_SortItems)
+    {
+        const DrawCommand& command = m_Commands[item.Index];
+        const VertexArray* va = command.VA;
+        const IndexBuffer* ib = command.IB;
+        Shader* program = command.Program;
+        if (command.Resources)
+        {
+            va = command.Resources->Get(command.VAHandle);
+            ib = command.Resources->Get(command.IBHandle);
+            program = command.Resources->Get(command.ProgramHandle);
+            if (!va || !ib || !program)
+                continue;
+        }
+
+        program->Bind();
+        // 同一程序下材质相同时 uniform 已经是这些值，不必重新上传
+        if (program != lastProgram || command.Material != lastMaterial)
+        {
+            UniformSet::Apply(*program, m_Uniforms.data() + command.Uniforms, command.UniformCount);
+            m_Stats.UniformUploads++;
+        }
+        else if (command.UniformCount != 0)
+        {
+            m_Stats.UniformUploadsSkipped++;
+        }
+        lastProgram = program;
+        lastMaterial = command.Material;
+
+        // 同一页中的网格共用 VAO 和索引缓冲，这两次绑定会被 GLState 跳过；
+        // 共用格式 VAO 的网格只切换顶点缓冲
+        va->Bind();
+        if (command.VB)
+            va->BindVertexBuffer(0, *command.VB);
+        ib->Bind();
+        DrawElements(ib->GetCount(), ib->GetType(), ib->GetOffset(), command.InstanceCount, command.BaseVertex);
+        m_Stats.DrawCalls++;
+        m_Stats.Instances += command.InstanceCount;
+    }
+
+    m_Commands.clear();
+    m_Uniforms.clear();
+    m_SortItems.clear();
+}
+
+void Renderer::RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch)
+{
+    // LSD 基数排序，每趟 8 位；所有键在这一位上都相同时跳过这一趟
+    size_t count = items.size();
+    if (count < 2)
+        return;
+    scratch.resize(count);
+
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] = {};
+        for (const SortItem& item : items)
+            histogram[(item.Key >> shift) & 0xFF]++;
+        if (histogram[(items[0].Key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram)
+        {
+            size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (const SortItem& item : items)
+            scratch[histogram[(item.Key >> shift) & 0xFF]++] = item;
+        items.swap(scratch);
+    }
+}
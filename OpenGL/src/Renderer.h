@@ -1,14 +1,141 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <vector>
+#include "GLTrace.h"
+#include "SlotMap.h"
+#include "UniformSet.h"
+
+// GLCall 的错误检查级别（可在编译时通过 GL_CHECK_LEVEL 指定）
+#define GL_CHECK_OFF      0 // GLCall(x) 直接展开为 x，没有任何额外开销
+#define GL_CHECK_DEFERRED 1 // 只记录调用位置，由 GLCheckFrame() 每帧统一检查一次
+#define GL_CHECK_FULL     2 // 每次调用前后都检查 glGetError，并报告文件和行号
+
+#ifndef GL_CHECK_LEVEL
+    #ifdef NDEBUG
+        #define GL_CHECK_LEVEL GL_CHECK_OFF
+    #else
+        #define GL_CHECK_LEVEL GL_CHECK_FULL
+    #endif
+#endif
 
 #define ASSERT(x) if (!(x)) __debugbreak();
-#define GLCall(x) GLClearError();\
+
+#if GL_CHECK_LEVEL == GL_CHECK_FULL
+#define GLCall(x) GLSetCallSite(#x, __FILE__, __LINE__);\
+    GLClearError();\
     x;\
     ASSERT(GLLogCall(#x,__FILE__,__LINE__))
+#elif GL_CHECK_LEVEL == GL_CHECK_DEFERRED
+#define GLCall(x) GLSetCallSite(#x, __FILE__, __LINE__);\
+    x
+#else
+#define GLCall(x) x
+#endif
+
+#if GL_CHECK_LEVEL != GL_CHECK_OFF
+#define GLCheckFrame() ASSERT(GLCheckErrors())
+#else
+#define GLCheckFrame()
+#endif
+
+struct GLCallSite
+{
+    const char* function;
+    const char* file;
+    int line;
+};
+
+extern GLCallSite g_GLCallSite;
+
+inline void GLSetCallSite(const char* function, const char* file, int line)
+{
+    g_GLCallSite = { function, file, line };
+}
 
 void GLClearError();
 
 bool GLLogCall(const char* function, const char* file, int line);
 
+// 取出所有积压的错误，并报告最近一次 GLCall 的位置
+bool GLCheckErrors();
+
+class VertexArray;
+class VertexBuffer;
+class IndexBuffer;
+class Shader;
+class ResourceManager;
+
+struct RendererStats
+{
+    unsigned int Submitted = 0;
+    unsigned int DrawCalls = 0;
+    unsigned int Instances = 0;
+    unsigned int UniformUploads = 0;
+    unsigned int UniformUploadsSkipped = 0;
+};
+
+// 绘制命令先进入每帧的队列，Flush 时按 64 位排序键（程序、VAO、材质、深度）基数排序后执行，
+// 使相同状态的绘制相邻，配合 GLState 把状态切换减到最少
+class Renderer
+{
+private:
+    struct DrawCommand
+    {
+        const VertexArray* VA;
+        const VertexBuffer* VB; // 非空时 VA 只有格式，绘制前挂到绑定点 0
+        const IndexBuffer* IB;
+        Shader* Program;
+        unsigned int Uniforms;     // 在 m_Uniforms 中的起始下标
+        unsigned int UniformCount;
+        unsigned int InstanceCount;
+        int BaseVertex;
+        unsigned long long Material;
+        // 通过句柄提交的命令只保存句柄，Flush 时再查表，此时上面三个指针为空
+        ResourceManager* Resources = nullptr;
+        Handle<VertexArray> VAHandle;
+        Handle<IndexBuffer> IBHandle;
+        Handle<Shader> ProgramHandle;
+    };
+
+    struct SortItem
+    {
+        unsigned long long Key;
+        unsigned int Index;
+    };
+
+    std::vector<DrawCommand> m_Commands;
+    std::vector<UniformValue> m_Uniforms; // 本帧所有命令的 uniform 连续存放，Flush 后清空但保留容量
+    std::vector<SortItem> m_SortItems;
+    std::vector<SortItem> m_SortScratch;
+    RendererStats m_Stats;
+public:
+    void Clear() const;
+    // 立即绘制，不经过队列。索引从 ib.GetOffset() 开始读取，baseVertex 用于 BufferPool 中共享 VAO 的网格
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, int baseVertex = 0) const;
+    void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount, int baseVertex = 0) const;
+    // format 是只含格式的 VAO（VertexArray::AddFormat / VertexArrayCache），vb 在绘制前挂到绑定点 0
+    void Draw(const VertexArray& format, const VertexBuffer& vb, const IndexBuffer& ib, const Shader& shader) const;
+
+    // depth 取 [0, 1]，同一程序/VAO/材质内从小到大绘制
+    void Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader,
+        const UniformSet& uniforms = UniformSet(), float depth = 0.0f, int baseVertex = 0);
+    void SubmitInstanced(const VertexArray& va, const IndexBuffer& ib, Shader& shader, unsigned int instanceCount,
+        const UniformSet& uniforms = UniformSet(), float depth = 0.0f, int baseVertex = 0);
+    // 共用格式 VAO 的网格按 VAO 排在一起，相邻绘制之间只切换顶点缓冲和索引缓冲
+    void Submit(const VertexArray& format, const VertexBuffer& vb, const IndexBuffer& ib, Shader& shader,
+        const UniformSet& uniforms = UniformSet(), float depth = 0.0f);
+    // 通过句柄提交：提交时查表计算排序键，任一句柄已失效则返回 false；Flush 时再查一次，
+    // 其间销毁的资源对应的绘制被跳过，resources 本身要活到 Flush 之后
+    bool Submit(ResourceManager& resources, Handle<VertexArray> va, Handle<IndexBuffer> ib, Handle<Shader> shader,
+        const UniformSet& uniforms = UniformSet(), float depth = 0.0f, int baseVertex = 0);
+    void Flush();
+
+    inline const RendererStats& GetStats() const { return m_Stats; }
+    inline void ResetStats() { m_Stats = RendererStats(); }
 
+    // 按需选择 glDrawElements / Instanced / BaseVertex 变体，offset 为索引缓冲中的字节偏移
+    static void DrawElements(unsigned int count, unsigned int type, unsigned int offset, unsigned int instanceCount, int baseVertex);
+private:
+    static void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <tuple>
+#include "SlotMap.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+
+using VertexBufferHandle = Handle<VertexBuffer>;
+using IndexBufferHandle = Handle<IndexBuffer>;
+using VertexArrayHandle = Handle<VertexArray>;
+using ShaderHandle = Handle<Shader>;
+
+// 持有所有 GL 资源对象，外部只保存 32 位句柄。资源按类型存放在各自的 SlotMap 中，
+// 句柄查找只是两次数组下标；销毁后旧句柄的 Get 返回 nullptr
+class ResourceManager
+{
+private:
+    std::tuple<SlotMap<VertexBuffer>, SlotMap<IndexBuffer>, SlotMap<VertexArray>, SlotMap<Shader>> m_Storage;
+public:
+    ResourceManager() = default;
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+
+    template<typename T, typename... Args>
+    Handle<T> Create(Args&&... args)
+    {
+        return GetStorage<T>().Emplace(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    bool Destroy(Handle<T> handle)
+    {
+        return GetStorage<T>().Remove(handle);
+    }
+
+    template<typename T>
+    inline T* Get(Handle<T> handle)
+    {
+        return GetStorage<T>().Get(handle);
+    }
+
+    template<typename T>
+    inline bool IsAlive(Handle<T> handle) const
+    {
+        return std::get<SlotMap<T>>(m_Storage).Contains(handle);
+    }
+
+    template<typename T>
+    inline SlotMap<T>& GetStorage()
+    {
+        return std::get<SlotMap<T>>(m_Storage);
+    }
+
+    // VAO 引用缓冲、程序独立，按依赖的反方向释放
+    void Clear()
+    {
+        GetStorage<VertexArray>().Clear();
+        GetStorage<IndexBuffer>().Clear();
+        GetStorage<VertexBuffer>().Clear();
+        GetStorage<Shader>().Clear();
+    }
+
+    ~ResourceManager()
+    {
+        Clear();
+    }
+};
@@ -1,101 +1,383 @@
 #include "Shader.h"
+#include <algorithm>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
+#include <vector>
 #include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "ProgramBinaryCache.h"
+
+namespace
+{
+    struct StageInfo
+    {
+        std::string_view Name; // #shader 后面的名字
+        unsigned int Type;
+    };
+
+    // 按 ShaderStage 的顺序
+    const StageInfo s_Stages[ShaderStageCount] = {
+        { "vertex",          GL_VERTEX_SHADER },
+        { "fragment",        GL_FRAGMENT_SHADER },
+        { "geometry",        GL_GEOMETRY_SHADER },
+        { "tess_control",    GL_TESS_CONTROL_SHADER },
+        { "tess_evaluation", GL_TESS_EVALUATION_SHADER },
+        { "compute",         GL_COMPUTE_SHADER },
+    };
+
+    bool IsBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    bool IsBlank(std::string_view text)
+    {
+        for (char c : text)
+        {
+            if (!IsBlank(c))
+                return false;
+        }
+        return true;
+    }
+
+    std::string_view Trim(std::string_view text)
+    {
+        while (!text.empty() && IsBlank(text.front()))
+            text.remove_prefix(1);
+        while (!text.empty() && IsBlank(text.back()))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    // 第一条 #shader 之前只允许空行、// 注释和 #keywords 声明
+    void ParsePreamble(std::string_view text, std::vector<std::string_view>& keywords, const std::string& filepath)
+    {
+        const std::string_view directive = "#keywords";
+        bool warned = false;
+        while (!text.empty())
+        {
+            size_t lineEnd = text.find('\n');
+            std::string_view line = Trim(text.substr(0, lineEnd));
+            text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+            if (line.empty() || line.substr(0, 2) == "//")
+                continue;
+            if (line.substr(0, directive.size()) != directive || (line.size() > directive.size() && !IsBlank(line[directive.size()])))
+            {
+                if (!warned)
+                    std::cout << "[Shader] " << filepath << ": text before the first #shader is ignored" << std::endl;
+                warned = true;
+                continue;
+            }
+
+            std::string_view rest = line.substr(directive.size());
+            while (!(rest = Trim(rest)).empty())
+            {
+                size_t end = 0;
+                while (end < rest.size() && !IsBlank(rest[end]))
+                    end++;
+                std::string_view keyword = rest.substr(0, end);
+                rest.remove_prefix(end);
+                if (std::find(keywords.begin(), keywords.end(), keyword) != keywords.end())
+                    continue;
+                if (keywords.size() == MaxShaderKeywords)
+                {
+                    std::cout << "[Shader] " << filepath << ": too many keywords, " << keyword << " is ignored" << std::endl;
+                    continue;
+                }
+                keywords.push_back(keyword);
+            }
+        }
+    }
+
+    // #version 所在行之后的位置，没有 #version 时为 0
+    size_t FindVersionEnd(std::string_view source)
+    {
+        const std::string_view directive = "#version";
+        size_t pos = 0;
+        while ((pos = source.find(directive, pos)) != std::string_view::npos)
+        {
+            size_t newline = source.rfind('\n', pos);
+            size_t lineStart = newline == std::string_view::npos ? 0 : newline + 1;
+            size_t lineEnd = source.find('\n', pos);
+            if (IsBlank(source.substr(lineStart, pos - lineStart)))
+                return lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+            pos += directive.size();
+        }
+        return 0;
+    }
+
+    // 不检查编译状态，结果在 FinishBuild 中与链接状态一起查询。
+    // 源码带长度传入，切片不需要以 '\0' 结尾；宏定义作为第二个字符串插在 #version 之后，源码本身不复制。
+    // 宏定义后面跟一条 #line，把行号和源字符串编号恢复成根文件的，错误位置与不带宏定义时一致
+    unsigned int CompileShader(unsigned int type, std::string_view source, std::string_view defines)
+    {
+        GLCall(unsigned int id = glCreateShader(type));
+        if (defines.empty())
+        {
+            const char* src = source.data();
+            GLint length = (GLint)source.size();
+            GLCall(glShaderSource(id, 1, &src, &length));
+        }
+        else
+        {
+            size_t split = FindVersionEnd(source);
+            size_t nextLine = (size_t)std::count(source.begin(), source.begin() + split, '\n') + 1;
+            std::string prefix(defines);
+            if (prefix.back() != '\n')
+                prefix.push_back('\n');
+            prefix.append("#line ").append(std::to_string(nextLine)).append(" 0\n");
+            const char* strings[3] = { source.data(), prefix.data(), source.data() + split };
+            GLint lengths[3] = { (GLint)split, (GLint)prefix.size(), (GLint)(source.size() - split) };
+            GLCall(glShaderSource(id, 3, strings, lengths));
+        }
+        GLCall(glCompileShader(id));
+        return id;
+    }
+
+    void PrintShaderLog(unsigned int id, unsigned int stage)
+    {
+        int result;
+        GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+        if (result == GL_TRUE)
+            return;
+        int length;
+        GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
+        std::string message(length > 0 ? length : 1, '\0');
+        GLCall(glGetShaderInfoLog(id, (GLsizei)message.size(), &length, &message[0]));
+        std::cout << "Failed to compile " << s_Stages[stage].Name << " shader!" << std::endl;
+        std::cout << message.c_str() << std::endl;
+    }
+}
 
 Shader::Shader(const std::string& filepath):m_FilePath(filepath), m_RendererID(0)
 {
-    ShaderProgramSource source = ParseShader(filepath);
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+    ProgramBuild build = StartBuild(ParseShader(filepath));
+    FinishBuild(build, filepath);
+    m_RendererID = build.Program;
+}
+
+Shader::Shader(const std::string& filepath, unsigned int program) : m_FilePath(filepath), m_RendererID(program)
+{
 }
 
 Shader::~Shader()
 {
-    GLCall(glDeleteProgram(m_RendererID));
+    Release();
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+Shader::Shader(Shader&& other) noexcept
+    : m_FilePath(std::move(other.m_FilePath)), m_RendererID(other.m_RendererID),
+      m_UniformLocationCache(std::move(other.m_UniformLocationCache))
 {
-    std::ifstream stream(filepath);
+    other.m_RendererID = 0;
+}
 
-    enum class ShaderType
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+    if (this != &other)
     {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
-    };
+        Release();
+        m_FilePath = std::move(other.m_FilePath);
+        m_RendererID = other.m_RendererID;
+        m_UniformLocationCache = std::move(other.m_UniformLocationCache);
+        other.m_RendererID = 0;
+    }
+    return *this;
+}
 
-    std::string line;
-    std::stringstream ss[2];
-    ShaderType type = ShaderType::NONE;
-    while (getline(stream, line))
+bool Shader::Reload()
+{
+    ProgramBuild build = StartBuild(ParseShader(m_FilePath));
+    if (!FinishBuild(build, m_FilePath))
+    {
+        DeletionQueue::DeleteProgram(build.Program);
+        return false;
+    }
+    Release();
+    m_RendererID = build.Program;
+    m_UniformLocationCache.clear();
+    return true;
+}
+
+void Shader::Release()
+{
+    if (m_RendererID == 0)
+        return;
+    DeletionQueue::DeleteProgram(m_RendererID);
+    m_RendererID = 0;
+}
+
+ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+{
+    ShaderProgramSource source;
+    source.Unit = ShaderPreprocessor::Load(filepath);
+    if (!source.Unit)
+    {
+        std::cout << "Failed to open " << filepath << "!" << std::endl;
+        return source;
+    }
+
+    const std::string_view directive = "#shader";
+    std::string_view text = source.Unit->Text;
+    bool seen[ShaderStageCount] = {};
+    bool foundDirective = false;
+    int stage = -1;   // 当前正文属于的阶段，-1 表示丢弃
+    size_t begin = 0; // 当前正文的起点
+    size_t pos = 0;
+    while (true)
     {
-        if (line.find("#shader") != std::string::npos)
+        size_t hit = text.find(directive, pos);
+        size_t lineStart = text.size();
+        if (hit != std::string_view::npos)
         {
-            if (line.find("vertex") != std::string::npos)
+            size_t newline = text.rfind('\n', hit);
+            lineStart = newline == std::string_view::npos ? 0 : newline + 1;
+            // 只认行首（允许前导空白）的指令，注释或字符串中的 #shader 属于正文
+            if (!IsBlank(text.substr(lineStart, hit - lineStart)))
             {
-                type = ShaderType::VERTEX;
-            }else if (line.find("fragment") != std::string::npos)
-            {
-                type = ShaderType::FRAGMENT;
+                pos = hit + directive.size();
+                continue;
             }
         }
+
+        // 上一段正文到这条指令所在行之前为止
+        std::string_view body = text.substr(begin, lineStart - begin);
+        if (stage >= 0)
+            source.Stages[stage] = body;
+        else if (!foundDirective)
+            ParsePreamble(body, source.Keywords, filepath);
+        if (hit == std::string_view::npos)
+            break;
+
+        size_t lineEnd = text.find('\n', hit);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
+        std::string_view name = Trim(text.substr(hit + directive.size(), lineEnd - hit - directive.size()));
+        foundDirective = true;
+        stage = -1;
+        for (unsigned int i = 0; i < ShaderStageCount; i++)
+        {
+            if (s_Stages[i].Name == name)
+                stage = (int)i;
+        }
+        if (stage < 0)
+        {
+            std::cout << "[Shader] " << filepath << ": unknown stage '" << name << "' is ignored" << std::endl;
+        }
+        else if (seen[stage])
+        {
+            std::cout << "[Shader] " << filepath << ": duplicate " << name << " stage is ignored" << std::endl;
+            stage = -1;
+        }
         else
         {
-            ss[(int)type] << line << '\n';
+            seen[stage] = true;
+        }
+        begin = pos = lineEnd == text.size() ? lineEnd : lineEnd + 1;
+    }
+
+    // 计算着色器只能单独组成程序
+    if (seen[(unsigned int)ShaderStage::Compute])
+    {
+        for (unsigned int i = 0; i < ShaderStageCount; i++)
+        {
+            if (seen[i] && i != (unsigned int)ShaderStage::Compute)
+            {
+                std::cout << "[Shader] " << filepath << ": compute stage cannot be combined with " << s_Stages[i].Name << std::endl;
+                break;
+            }
         }
     }
-    return { ss[0].str(), ss[1].str() };
+    return source;
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+ProgramBuild Shader::StartBuild(const ShaderProgramSource& source, std::string_view defines)
 {
-	unsigned int id = glCreateShader(type);
-	const char* src = source.c_str();
-	glShaderSource(id, 1, &src, nullptr);
-	glCompileShader(id);
+    ProgramBuild build;
+    // 源码和驱动都没变时直接加载上次链接好的二进制
+    build.Key = ProgramBinaryCache::MakeKey(std::vector<std::string_view>(source.Stages, source.Stages + ShaderStageCount), defines);
+    build.Program = ProgramBinaryCache::Load(build.Key);
+    if (build.Program != 0)
+    {
+        build.FromCache = true;
+        return build;
+    }
 
-	int result;
-	glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-	if (result == GL_FALSE)
-	{
-		int length;
-		GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
-		char* message = (char*)alloca(length * sizeof(char));
-		GLCall(glGetShaderInfoLog(id,length, &length, message));
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
-        std::cout << message << std::endl;
-		GLCall(glDeleteShader(id));
-		return 0;
-	}
-    return id;
+    GLCall(build.Program = glCreateProgram());
+    for (unsigned int i = 0; i < ShaderStageCount; i++)
+    {
+        if (source.Stages[i].empty())
+            continue;
+        build.Shaders[i] = CompileShader(s_Stages[i].Type, source.Stages[i], defines);
+        GLCall(glAttachShader(build.Program, build.Shaders[i]));
+    }
+    if (ProgramBinaryCache::IsEnabled())
+    {
+        GLCall(glProgramParameteri(build.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+    GLCall(glLinkProgram(build.Program));
+    return build;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+bool Shader::FinishBuild(ProgramBuild& build, const std::string& name)
 {
-	GLCall(unsigned int program = glCreateProgram());
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    if (build.FromCache)
+        return true;
 
-    GLCall(glAttachShader(program, vs));
-    GLCall(glAttachShader(program, fs));
-    GLCall(glLinkProgram(program));
-    GLCall(glValidateProgram(program));
+    int linked;
+    GLCall(glGetProgramiv(build.Program, GL_LINK_STATUS, &linked));
+    if (linked == GL_FALSE)
+    {
+        for (unsigned int i = 0; i < ShaderStageCount; i++)
+        {
+            if (build.Shaders[i] != 0)
+                PrintShaderLog(build.Shaders[i], i);
+        }
+        int length;
+        GLCall(glGetProgramiv(build.Program, GL_INFO_LOG_LENGTH, &length));
+        std::string message(length > 0 ? length : 1, '\0');
+        GLCall(glGetProgramInfoLog(build.Program, (GLsizei)message.size(), &length, &message[0]));
+        std::cout << "Failed to link " << name << "!" << std::endl;
+        std::cout << message.c_str() << std::endl;
+    }
+    else
+    {
+        GLCall(glValidateProgram(build.Program));
+    }
 
-    GLCall(glDeleteShader(vs));
-    GLCall(glDeleteShader(fs));
+    for (unsigned int& shader : build.Shaders)
+    {
+        if (shader == 0)
+            continue;
+        GLCall(glDeleteShader(shader));
+        shader = 0;
+    }
 
-	return program;
+    if (linked == GL_FALSE)
+        return false;
+    ProgramBinaryCache::Store(build.Key, build.Program);
+    return true;
 }
 
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    GLState::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    GLState::UseProgram(0);
+}
+
+void Shader::SetUniform1i(const std::string& name, int value)
+{
+    GLCall(glUniform1i(GetUniformLocation(name), value));
+}
+
+void Shader::SetUniform1f(const std::string& name, float value)
+{
+    GLCall(glUniform1f(GetUniformLocation(name), value));
 }
 
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
@@ -103,6 +385,11 @@ void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2,
     GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
 }
 
+void Shader::SetUniformMat4f(const std::string& name, const float* matrix)
+{
+    GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, matrix));
+}
+
 unsigned int Shader::GetUniformLocation(const std::string& name)
 {
     if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
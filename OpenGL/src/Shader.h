@@ -1,15 +1,44 @@
-#pragma 
+#pragma once
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <memory>
+#include <vector>
+#include "ShaderPreprocessor.h"
 
+// 顺序与 .shader 文件中 #shader 指令可用的名字一一对应，见 Shader.cpp
+enum class ShaderStage
+{
+    Vertex, Fragment, Geometry, TessControl, TessEvaluation, Compute, Count
+};
+static const unsigned int ShaderStageCount = (unsigned int)ShaderStage::Count;
+// 变体掩码的位数，见 ShaderVariants
+static const unsigned int MaxShaderKeywords = 32;
+
+// 各阶段的源码是预处理结果中的切片，没有复制；文件里没有的阶段为空。
+// Keywords 来自第一条 #shader 之前的 #keywords 声明，按声明顺序对应变体掩码的各位
 struct ShaderProgramSource
 {
-	std::string VertexSource;
-	std::string FragmentSource;
+    std::shared_ptr<const ShaderUnit> Unit;
+    std::string_view Stages[ShaderStageCount];
+    std::vector<std::string_view> Keywords;
+
+    inline std::string_view Get(ShaderStage stage) const { return Stages[(unsigned int)stage]; }
+};
+
+// 一次程序构建的中间状态：StartBuild 发出编译和链接命令，FinishBuild 再查询结果
+struct ProgramBuild
+{
+    unsigned int Program = 0;
+    unsigned int Shaders[ShaderStageCount] = {};
+    unsigned long long Key = 0;
+    bool FromCache = false; // 从二进制缓存加载，已经链接完成
 };
 
 class Shader
 {
+    friend class ShaderCompiler;
+    friend class ShaderVariants;
 private:
     std::string m_FilePath;
 	unsigned int m_RendererID;
@@ -19,13 +48,36 @@ public:
 	Shader(const std::string& filepath);
 	~Shader();
 
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
+	void SetUniform1i(const std::string& name, int value);
+	void SetUniform1f(const std::string& name, float value);
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(const std::string& name, const float* matrix);
+
+	// 重新读取源码并构建，成功时替换程序（之前设置的 uniform 值随旧程序丢弃），失败时保留旧程序
+	bool Reload();
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
 private:
-	ShaderProgramSource ParseShader(const std::string& filepath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-    unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+	// 接管已经链接好的程序（ShaderCompiler 异步编译完成后使用）
+	Shader(const std::string& filepath, unsigned int program);
+
+	void Release();
+	// 经过 ShaderPreprocessor 展开 #include，只在 "#shader" 出现的位置检查是否为行首的指令，不逐行处理
+	static ShaderProgramSource ParseShader(const std::string& filepath);
+	// 只发出命令、不查询任何状态，驱动支持并行编译时立即返回；命中二进制缓存时程序已经可用。
+	// defines 插在每个阶段的 #version 之后
+	static ProgramBuild StartBuild(const ShaderProgramSource& source, std::string_view defines = std::string_view());
+	// 查询链接结果（失败时再取各阶段的编译日志），释放着色器对象，成功时写入二进制缓存。
+	// 会等待驱动完成编译，异步使用时先确认 GL_COMPLETION_STATUS
+	static bool FinishBuild(ProgramBuild& build, const std::string& name);
 	unsigned int GetUniformLocation(const std::string& name);
 };
 
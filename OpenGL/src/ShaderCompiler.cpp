@@ -0,0 +1,128 @@
+#include "ShaderCompiler.h"
+#include "Renderer.h"
+#include "GLCaps.h"
+#include "DeletionQueue.h"
+
+namespace
+{
+    Shader* s_DefaultFallback = nullptr;
+
+    bool IsComplete(const ProgramBuild& build)
+    {
+        GLint complete = GL_FALSE;
+        GLCall(glGetProgramiv(build.Program, GL_COMPLETION_STATUS_KHR, &complete));
+        return complete == GL_TRUE;
+    }
+}
+
+std::vector<std::shared_ptr<ShaderFuture::State>> ShaderCompiler::s_Pending;
+
+Shader* ShaderFuture::Get() const
+{
+    if (!m_State)
+        return nullptr;
+    if (m_State->Status == ShaderStatus::Ready)
+        return &*m_State->Program;
+    return m_State->Fallback;
+}
+
+Shader* ShaderFuture::Wait()
+{
+    if (m_State && m_State->Status == ShaderStatus::Pending)
+        ShaderCompiler::Finish(*m_State);
+    return Get();
+}
+
+void ShaderCompiler::Init()
+{
+    // 0xFFFFFFFF 表示由驱动决定线程数
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+        GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+    }
+}
+
+ShaderFuture ShaderCompiler::Submit(const std::string& filepath, Shader* fallback)
+{
+    return Submit(filepath, Shader::ParseShader(filepath), std::string_view(), filepath, fallback);
+}
+
+ShaderFuture ShaderCompiler::Submit(const std::string& filepath, const ShaderProgramSource& source, std::string_view defines,
+    const std::string& name, Shader* fallback)
+{
+    ShaderFuture future;
+    future.m_State = std::make_shared<ShaderFuture::State>();
+    future.m_State->FilePath = filepath;
+    future.m_State->Name = name;
+    future.m_State->Fallback = fallback ? fallback : s_DefaultFallback;
+    future.m_State->Build = Shader::StartBuild(source, defines);
+    if (future.m_State->Build.FromCache)
+        Finish(*future.m_State);
+    else
+        s_Pending.push_back(future.m_State);
+    return future;
+}
+
+void ShaderCompiler::SetDefaultFallback(Shader* fallback)
+{
+    s_DefaultFallback = fallback;
+}
+
+void ShaderCompiler::Finish(ShaderFuture::State& state)
+{
+    if (Shader::FinishBuild(state.Build, state.Name))
+    {
+        state.Program.emplace(Shader(state.FilePath, state.Build.Program));
+        state.Status = ShaderStatus::Ready;
+    }
+    else
+    {
+        DeletionQueue::DeleteProgram(state.Build.Program);
+        state.Status = ShaderStatus::Failed;
+    }
+    state.Build.Program = 0;
+}
+
+void ShaderCompiler::Poll()
+{
+    bool parallel = GLCaps::Get().ParallelShaderCompile;
+    bool finishedOne = false;
+    for (size_t i = 0; i < s_Pending.size();)
+    {
+        ShaderFuture::State& state = *s_Pending[i];
+        if (state.Status == ShaderStatus::Pending)
+        {
+            // 没有 GL_COMPLETION_STATUS 时无法知道是否完成，每帧只等一个
+            bool ready = parallel ? IsComplete(state.Build) : !finishedOne;
+            if (!ready)
+            {
+                i++;
+                continue;
+            }
+            Finish(state);
+            finishedOne = true;
+        }
+        // 已经由 ShaderFuture::Wait 完成的直接移出队列
+        s_Pending[i] = s_Pending.back();
+        s_Pending.pop_back();
+    }
+}
+
+void ShaderCompiler::WaitAll()
+{
+    for (const auto& state : s_Pending)
+    {
+        if (state->Status == ShaderStatus::Pending)
+            Finish(*state);
+    }
+    s_Pending.clear();
+}
+
+unsigned int ShaderCompiler::GetPendingCount()
+{
+    return (unsigned int)s_Pending.size();
+}
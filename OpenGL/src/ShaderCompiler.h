@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Shader.h"
+
+enum class ShaderStatus
+{
+    Pending, Ready, Failed
+};
+
+// ShaderCompiler::Submit 返回的句柄，可以复制；编译完成前 Get 返回后备程序，帧循环不必等待
+class ShaderFuture
+{
+    friend class ShaderCompiler;
+private:
+    struct State
+    {
+        std::string FilePath;
+        std::string Name; // 编译日志中显示的名字，变体带关键字
+        ProgramBuild Build;
+        ShaderStatus Status = ShaderStatus::Pending;
+        std::optional<Shader> Program;
+        Shader* Fallback = nullptr;
+    };
+    std::shared_ptr<State> m_State;
+public:
+    ShaderFuture() = default;
+
+    inline bool IsValid() const { return m_State != nullptr; }
+    inline ShaderStatus GetStatus() const { return m_State ? m_State->Status : ShaderStatus::Failed; }
+    inline bool IsReady() const { return GetStatus() == ShaderStatus::Ready; }
+
+    // 已完成时返回编译好的程序，否则（包括编译失败）返回后备程序，可能为 nullptr
+    Shader* Get() const;
+    // 阻塞直到这个程序完成，返回值同 Get
+    Shader* Wait();
+};
+
+// 异步编译着色器程序：Submit 读入源码并立即发出所有编译和链接命令，不查询任何状态；
+// 每帧调用 Poll，用 GL_COMPLETION_STATUS 非阻塞地检查哪些程序已经完成。
+// 驱动不支持 parallel_shader_compile 时状态查询会阻塞，Poll 每次最多完成一个程序，把等待分摊到多帧
+class ShaderCompiler
+{
+    friend class ShaderFuture;
+public:
+    // 在 GLCaps::Init 之后调用，让驱动自己决定编译线程数
+    static void Init();
+
+    // 未指定 fallback 时使用 SetDefaultFallback 设置的程序
+    static ShaderFuture Submit(const std::string& filepath, Shader* fallback = nullptr);
+    // 已经解析好的源码，defines 插在每个阶段的 #version 之后（见 ShaderVariants）
+    static ShaderFuture Submit(const std::string& filepath, const ShaderProgramSource& source, std::string_view defines,
+        const std::string& name, Shader* fallback = nullptr);
+    static void SetDefaultFallback(Shader* fallback);
+
+    // 每帧调用一次
+    static void Poll();
+    static void WaitAll();
+    static unsigned int GetPendingCount();
+private:
+    // 还在编译的程序；ShaderFuture::State 是私有类型，所以放在类里而不是 .cpp 的匿名命名空间
+    static std::vector<std::shared_ptr<ShaderFuture::State>> s_Pending;
+
+    // 查询结果并生成 Shader；驱动还没编译完时会等待
+    static void Finish(ShaderFuture::State& state);
+};
@@ -0,0 +1,98 @@
+#include "ShaderLibrary.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+ShaderVariants& ShaderLibrary::Get(const std::string& filepath)
+{
+    std::string path = ShaderPreprocessor::Normalize(filepath);
+    return m_Shaders.try_emplace(path, path).first->second;
+}
+
+unsigned int ShaderLibrary::Prewarm(const std::string& manifestPath)
+{
+    std::ifstream stream(manifestPath);
+    if (!stream)
+        return 0;
+
+    // 同一个着色器的变体放在一起，一次发出所有编译命令
+    std::vector<std::pair<ShaderVariants*, std::vector<unsigned int>>> requests;
+    unsigned int count = 0;
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        std::istringstream words(line);
+        std::string path;
+        if (!(words >> path) || path[0] == '#')
+            continue;
+
+        ShaderVariants& variants = Get(path);
+        unsigned int mask = 0;
+        std::string keyword;
+        while (words >> keyword)
+            mask |= variants.GetMask(keyword);
+
+        auto it = std::find_if(requests.begin(), requests.end(), [&](const auto& request) { return request.first == &variants; });
+        if (it == requests.end())
+            it = requests.insert(requests.end(), { &variants, {} });
+        it->second.push_back(mask);
+        count++;
+    }
+
+    for (auto& request : requests)
+        request.first->Prewarm(request.second);
+    return count;
+}
+
+bool ShaderLibrary::SaveManifest(const std::string& manifestPath) const
+{
+    std::vector<std::string> lines;
+    for (const auto& pair : m_Shaders)
+    {
+        const std::vector<std::string>& keywords = pair.second.GetKeywords();
+        for (unsigned int mask : pair.second.GetRequestedMasks())
+        {
+            std::string line = pair.first;
+            for (size_t i = 0; i < keywords.size(); i++)
+            {
+                if (mask & (1u << i))
+                    line.append(" ").append(keywords[i]);
+            }
+            lines.push_back(line);
+        }
+    }
+    // 排序后输出，内容不变时文件也不变
+    std::sort(lines.begin(), lines.end());
+
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::path(manifestPath).parent_path();
+    if (!directory.empty())
+        std::filesystem::create_directories(directory, error);
+    std::ofstream stream(manifestPath, std::ios::trunc);
+    stream << "# shader variants used by the last run, prewarmed on startup\n";
+    for (const std::string& line : lines)
+        stream << line << '\n';
+    if (!stream)
+    {
+        std::cout << "[ShaderLibrary] cannot write " << manifestPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ShaderLibrary::Reload(const std::vector<std::string>& programs)
+{
+    for (const std::string& path : programs)
+    {
+        auto it = m_Shaders.find(ShaderPreprocessor::Normalize(path));
+        if (it != m_Shaders.end())
+            it->second.Reload();
+    }
+}
+
+void ShaderLibrary::Clear()
+{
+    m_Shaders.clear();
+}
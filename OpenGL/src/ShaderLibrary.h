@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ShaderVariants.h"
+
+// 按文件持有 ShaderVariants。清单是文本文件，每行一个变体：着色器路径后面跟空格分隔的关键字，
+// 没有关键字表示基础变体，空行和 # 开头的行忽略。启动时按清单预热，退出前把实际用到的变体写回，
+// 下次启动只编译真正用到的组合
+class ShaderLibrary
+{
+private:
+    std::unordered_map<std::string, ShaderVariants> m_Shaders; // 键经过 ShaderPreprocessor::Normalize
+public:
+    ShaderLibrary() = default;
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    ShaderVariants& Get(const std::string& filepath);
+
+    // 清单不存在时返回 0；返回清单中列出的变体数
+    unsigned int Prewarm(const std::string& manifestPath);
+    bool SaveManifest(const std::string& manifestPath) const;
+
+    // 传入 ShaderPreprocessor::PollChanges 的结果，只重新构建这里持有的、受影响的着色器
+    void Reload(const std::vector<std::string>& programs);
+
+    void Clear();
+};
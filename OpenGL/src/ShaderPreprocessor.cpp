@@ -0,0 +1,394 @@
+#include "ShaderPreprocessor.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // 一个文件的最新状态，修改时间和大小都没变时认为内容没变，不再读取
+    struct FileRecord
+    {
+        bool Checked = false;
+        bool Exists = false;
+        fs::file_time_type WriteTime;
+        uintmax_t Size = 0;
+        uint64_t Hash = 0;
+        bool NeedsExpansion = false;       // 含有 #include 或 #pragma once
+        std::vector<std::string> Includes; // 直接包含的文件，已解析为规范路径
+    };
+
+    struct ProgramRecord
+    {
+        uint64_t Key = 0;
+        std::vector<std::string> Files;     // 根文件和所有直接、间接包含的文件
+        std::shared_ptr<const ShaderUnit> Unit; // 只缓存展开过的结果
+    };
+
+    struct Directive
+    {
+        std::string_view Name;
+        std::string_view Argument;
+        size_t LineStart;
+        size_t Next; // 下一行的起点
+    };
+
+    struct ExpandContext
+    {
+        std::string& Output;
+        std::vector<std::string>& Sources; // 源串号 -> 文件
+        std::vector<std::string> Once;     // 当前阶段中已经展开过的 #pragma once 文件
+        std::vector<std::string> Stack;    // 正在展开的文件，用于发现循环包含
+    };
+
+    std::vector<fs::path> s_IncludeDirectories;
+    std::unordered_map<std::string, FileRecord> s_Files;
+    std::unordered_map<std::string, ProgramRecord> s_Programs;
+    ShaderPreprocessorStats s_Stats;
+
+    uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool IsBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    std::string_view Trim(std::string_view text)
+    {
+        while (!text.empty() && IsBlank(text.front()))
+            text.remove_prefix(1);
+        while (!text.empty() && IsBlank(text.back()))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    // 只在 '#' 出现的位置检查是否为行首（允许前导空白）的指令
+    template<typename Callback>
+    void ForEachDirective(std::string_view text, Callback&& callback)
+    {
+        size_t pos = 0;
+        while ((pos = text.find('#', pos)) != std::string_view::npos)
+        {
+            size_t newline = text.rfind('\n', pos);
+            size_t lineStart = newline == std::string_view::npos ? 0 : newline + 1;
+            size_t lineEnd = text.find('\n', pos);
+            if (lineEnd == std::string_view::npos)
+                lineEnd = text.size();
+            if (Trim(text.substr(lineStart, pos - lineStart)).empty())
+            {
+                std::string_view rest = Trim(text.substr(pos + 1, lineEnd - pos - 1));
+                size_t nameEnd = 0;
+                while (nameEnd < rest.size() && !IsBlank(rest[nameEnd]))
+                    nameEnd++;
+                size_t next = lineEnd == text.size() ? lineEnd : lineEnd + 1;
+                callback(Directive{ rest.substr(0, nameEnd), Trim(rest.substr(nameEnd)), lineStart, next });
+            }
+            pos = lineEnd;
+        }
+    }
+
+    bool ParseIncludeName(std::string_view argument, std::string_view& name, bool& quoted)
+    {
+        if (argument.size() < 2 || (argument.front() != '"' && argument.front() != '<'))
+            return false;
+        quoted = argument.front() == '"';
+        size_t close = argument.find(quoted ? '"' : '>', 1);
+        if (close == std::string_view::npos || close == 1)
+            return false;
+        name = argument.substr(1, close - 1);
+        return true;
+    }
+
+    std::string Resolve(const std::string& includer, std::string_view name, bool quoted)
+    {
+        std::error_code error;
+        if (quoted)
+        {
+            fs::path candidate = fs::path(includer).parent_path() / fs::path(name);
+            if (fs::is_regular_file(candidate, error))
+                return ShaderPreprocessor::Normalize(candidate.string());
+        }
+        for (const fs::path& directory : s_IncludeDirectories)
+        {
+            fs::path candidate = directory / fs::path(name);
+            if (fs::is_regular_file(candidate, error))
+                return ShaderPreprocessor::Normalize(candidate.string());
+        }
+        return std::string();
+    }
+
+    // 返回内容是否改变（第一次检查也算改变）
+    bool Refresh(const std::string& path, FileRecord& record)
+    {
+        std::error_code timeError, sizeError;
+        fs::file_time_type time = fs::last_write_time(path, timeError);
+        uintmax_t size = fs::file_size(path, sizeError);
+        bool exists = !timeError && !sizeError;
+        if (record.Checked && exists == record.Exists && (!exists || (time == record.WriteTime && size == record.Size)))
+            return false;
+
+        bool wasChecked = record.Checked;
+        bool existed = record.Exists;
+        uint64_t previous = record.Hash;
+        record.Checked = true;
+        record.Exists = exists;
+        record.WriteTime = time;
+        record.Size = size;
+        record.Hash = 0;
+        record.NeedsExpansion = false;
+        record.Includes.clear();
+        if (exists)
+        {
+            MappedFile file(path);
+            std::string_view text = file.GetView();
+            record.Hash = Hash(text.data(), text.size());
+            s_Stats.FilesHashed++;
+            ForEachDirective(text, [&](const Directive& directive)
+            {
+                std::string_view name;
+                bool quoted;
+                if (directive.Name == "pragma" && directive.Argument == "once")
+                {
+                    record.NeedsExpansion = true;
+                }
+                else if (directive.Name == "include")
+                {
+                    record.NeedsExpansion = true;
+                    if (!ParseIncludeName(directive.Argument, name, quoted))
+                        return;
+                    std::string resolved = Resolve(path, name, quoted);
+                    if (!resolved.empty() && std::find(record.Includes.begin(), record.Includes.end(), resolved) == record.Includes.end())
+                        record.Includes.push_back(resolved);
+                }
+            });
+        }
+        return !wasChecked || exists != existed || record.Hash != previous;
+    }
+
+    // 沿依赖图收集所有文件，同时把路径和内容哈希依次混入 key
+    void Collect(const std::string& path, std::vector<std::string>& files, uint64_t& key)
+    {
+        if (std::find(files.begin(), files.end(), path) != files.end())
+            return;
+        files.push_back(path);
+        FileRecord& record = s_Files[path];
+        Refresh(path, record);
+        key = Hash(path.data(), path.size(), key);
+        key = Hash(&record.Hash, sizeof(record.Hash), key);
+        for (const std::string& include : record.Includes)
+            Collect(include, files, key);
+    }
+
+    unsigned int SourceNumber(const std::string& path, ExpandContext& context)
+    {
+        auto it = std::find(context.Sources.begin(), context.Sources.end(), path);
+        if (it != context.Sources.end())
+            return (unsigned int)(it - context.Sources.begin());
+        context.Sources.push_back(path);
+        return (unsigned int)context.Sources.size() - 1;
+    }
+
+    void Expand(const std::string& path, ExpandContext& context)
+    {
+        MappedFile file(path);
+        std::string_view text = file.GetView();
+        bool isRoot = context.Stack.empty();
+        unsigned int source = SourceNumber(path, context);
+        context.Stack.push_back(path);
+
+        // 行号按需向后累计；根文件的行号从当前阶段（#shader 的下一行）算起
+        size_t counted = 0;
+        size_t newlines = 0;
+        size_t stageStart = 0;
+        auto lineAt = [&](size_t pos)
+        {
+            newlines += (size_t)std::count(text.begin() + counted, text.begin() + pos, '\n');
+            counted = pos;
+            return newlines - stageStart + 1;
+        };
+
+        size_t copied = 0;
+        ForEachDirective(text, [&](const Directive& directive)
+        {
+            // 每个阶段单独编译，#pragma once 的记录随阶段重置
+            if (isRoot && directive.Name == "shader")
+            {
+                context.Once.clear();
+                lineAt(directive.Next);
+                stageStart = newlines;
+                return;
+            }
+            bool once = directive.Name == "pragma" && directive.Argument == "once";
+            if (!once && directive.Name != "include")
+                return;
+
+            // 指令所在的行换成空行，后面的行号不变
+            context.Output.append(text.substr(copied, directive.LineStart - copied));
+            copied = directive.Next;
+            if (once)
+            {
+                if (!isRoot)
+                    context.Once.push_back(path);
+                context.Output.push_back('\n');
+                return;
+            }
+
+            std::string_view name;
+            bool quoted;
+            if (!ParseIncludeName(directive.Argument, name, quoted))
+            {
+                std::cout << "[ShaderPreprocessor] " << path << ": malformed #include " << directive.Argument << std::endl;
+                context.Output.push_back('\n');
+                return;
+            }
+            std::string resolved = Resolve(path, name, quoted);
+            if (resolved.empty())
+            {
+                std::cout << "[ShaderPreprocessor] " << path << ": cannot find " << name << std::endl;
+            }
+            else if (std::find(context.Once.begin(), context.Once.end(), resolved) != context.Once.end())
+            {
+                // 本阶段已经展开过，只留下空行
+            }
+            else if (std::find(context.Stack.begin(), context.Stack.end(), resolved) != context.Stack.end())
+            {
+                std::cout << "[ShaderPreprocessor] " << path << ": recursive #include of " << name << std::endl;
+            }
+            else if (context.Stack.size() >= ShaderPreprocessor::MaxIncludeDepth)
+            {
+                std::cout << "[ShaderPreprocessor] " << path << ": #include nested too deeply" << std::endl;
+            }
+            else
+            {
+                context.Output.append("#line 1 ").append(std::to_string(SourceNumber(resolved, context))).push_back('\n');
+                Expand(resolved, context);
+                if (!context.Output.empty() && context.Output.back() != '\n')
+                    context.Output.push_back('\n');
+                context.Output.append("#line ").append(std::to_string(lineAt(directive.Next)))
+                    .append(" ").append(std::to_string(source)).push_back('\n');
+                return;
+            }
+            context.Output.push_back('\n');
+        });
+        context.Output.append(text.substr(copied));
+        context.Stack.pop_back();
+    }
+}
+
+void ShaderPreprocessor::AddIncludeDirectory(const std::string& directory)
+{
+    s_IncludeDirectories.push_back(fs::path(directory));
+}
+
+std::shared_ptr<const ShaderUnit> ShaderPreprocessor::Load(const std::string& filepath)
+{
+    std::string path = Normalize(filepath);
+    std::vector<std::string> files;
+    uint64_t key = Hash(nullptr, 0);
+    Collect(path, files, key);
+    const FileRecord& root = s_Files[path];
+    if (!root.Exists)
+        return nullptr;
+
+    ProgramRecord& program = s_Programs[path];
+    program.Files = std::move(files);
+    if (program.Unit && program.Key == key)
+    {
+        s_Stats.Hits++;
+        return program.Unit;
+    }
+
+    auto unit = std::make_shared<ShaderUnit>();
+    unit->Key = key;
+    if (!root.NeedsExpansion)
+    {
+        // 映射只交给调用方，不缓存：Windows 上被映射的文件不能写入，编辑器保存时会失败
+        unit->File = MappedFile(path);
+        unit->Text = unit->File.GetView();
+        unit->Sources.push_back(path);
+        program.Unit = nullptr;
+        s_Stats.Direct++;
+    }
+    else
+    {
+        ExpandContext context{ unit->Expanded, unit->Sources, {}, {} };
+        Expand(path, context);
+        unit->Text = unit->Expanded;
+        program.Unit = unit;
+        s_Stats.Expansions++;
+    }
+    program.Key = key;
+    return unit;
+}
+
+std::vector<std::string> ShaderPreprocessor::PollChanges()
+{
+    std::vector<std::string> changed;
+    for (auto& pair : s_Files)
+    {
+        if (Refresh(pair.first, pair.second))
+            changed.push_back(pair.first);
+    }
+
+    std::vector<std::string> programs;
+    if (changed.empty())
+        return programs;
+    for (const auto& pair : s_Programs)
+    {
+        for (const std::string& file : pair.second.Files)
+        {
+            if (std::find(changed.begin(), changed.end(), file) != changed.end())
+            {
+                programs.push_back(pair.first);
+                break;
+            }
+        }
+    }
+    return programs;
+}
+
+std::vector<std::string> ShaderPreprocessor::GetDependents(const std::string& filepath)
+{
+    std::string path = Normalize(filepath);
+    std::vector<std::string> programs;
+    for (const auto& pair : s_Programs)
+    {
+        if (std::find(pair.second.Files.begin(), pair.second.Files.end(), path) != pair.second.Files.end())
+            programs.push_back(pair.first);
+    }
+    return programs;
+}
+
+std::string ShaderPreprocessor::Normalize(const std::string& filepath)
+{
+    return fs::path(filepath).lexically_normal().generic_string();
+}
+
+void ShaderPreprocessor::Clear()
+{
+    s_Files.clear();
+    s_Programs.clear();
+}
+
+const ShaderPreprocessorStats& ShaderPreprocessor::GetStats()
+{
+    return s_Stats;
+}
+
+void ShaderPreprocessor::PrintStats()
+{
+    std::cout << "[ShaderPreprocessor] " << s_Stats.Hits << " hits, " << s_Stats.Expansions << " expansions, "
+        << s_Stats.Direct << " direct, " << s_Stats.FilesHashed << " files hashed; "
+        << s_Files.size() << " files, " << s_Programs.size() << " programs" << std::endl;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+// 预处理后的整个 .shader 文件。没有 #include 时直接引用映射的文件，否则持有展开后的文本
+struct ShaderUnit
+{
+    MappedFile File;
+    std::string Expanded;
+    std::string_view Text;
+    uint64_t Key = 0; // 根文件和所有被包含文件的内容哈希
+    // #line 指令中的源串号对应的文件，0 为根文件；编译错误 "n:行号" 中的 n 按这里查找
+    std::vector<std::string> Sources;
+};
+
+struct ShaderPreprocessorStats
+{
+    unsigned int Hits = 0;       // 依赖都没变，直接返回缓存的展开结果
+    unsigned int Expansions = 0; // 重新展开 #include
+    unsigned int Direct = 0;     // 没有 #include，直接映射文件
+    unsigned int FilesHashed = 0;
+};
+
+// .shader 文件的 #include 预处理器。
+// #include "x" 先相对于所在文件查找，再查找 AddIncludeDirectory 添加的目录；#include <x> 只查找后者。
+// 被包含文件中的 #pragma once 在同一个阶段内只展开一次，每条 #shader 指令开始新的阶段，重新计算；
+// 传统的 #ifndef 保护由驱动的预处理器处理，同样按阶段生效。
+// 被包含文件的内容前后插入 #line，编译错误报告所在文件（源串号）和文件中的行号；根文件的行号从所在阶段算起。
+// 每个文件记录修改时间、内容哈希和直接包含的文件，组成依赖图；程序的展开结果按所有依赖的内容哈希缓存，
+// 修改时间变了但内容没变时不会重新构建
+class ShaderPreprocessor
+{
+public:
+    static const unsigned int MaxIncludeDepth = 32;
+
+    static void AddIncludeDirectory(const std::string& directory);
+
+    // 根文件打不开时返回 nullptr；找不到的、循环的包含会打印错误并删去那一行
+    static std::shared_ptr<const ShaderUnit> Load(const std::string& filepath);
+
+    // 检查所有已知文件，返回内容确实改变的文件直接或间接影响到的程序（路径经过 Normalize）
+    static std::vector<std::string> PollChanges();
+    // 直接或间接包含 filepath 的程序，包括它自己
+    static std::vector<std::string> GetDependents(const std::string& filepath);
+
+    static std::string Normalize(const std::string& filepath);
+    // 清空依赖图和缓存，保留包含目录
+    static void Clear();
+
+    static const ShaderPreprocessorStats& GetStats();
+    static void PrintStats();
+};
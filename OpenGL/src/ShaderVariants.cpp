@@ -0,0 +1,155 @@
+#include "ShaderVariants.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include "DeletionQueue.h"
+
+ShaderVariants::ShaderVariants(const std::string& filepath) : m_FilePath(filepath), m_Fallback(nullptr)
+{
+    ShaderProgramSource source = Shader::ParseShader(m_FilePath);
+    m_Keywords.assign(source.Keywords.begin(), source.Keywords.end());
+}
+
+unsigned int ShaderVariants::GetMask(std::string_view keyword) const
+{
+    for (size_t i = 0; i < m_Keywords.size(); i++)
+    {
+        if (m_Keywords[i] == keyword)
+            return 1u << i;
+    }
+    std::cout << "[ShaderVariants] " << m_FilePath << " does not declare keyword " << keyword << std::endl;
+    return 0;
+}
+
+unsigned int ShaderVariants::GetMask(std::initializer_list<std::string_view> keywords) const
+{
+    unsigned int mask = 0;
+    for (std::string_view keyword : keywords)
+        mask |= GetMask(keyword);
+    return mask;
+}
+
+Shader* ShaderVariants::Get(unsigned int mask)
+{
+    mask = Canonical(mask);
+    // 预热过的变体同样要记录，下次启动才会继续预热
+    if (std::find(m_Requested.begin(), m_Requested.end(), mask) == m_Requested.end())
+        m_Requested.push_back(mask);
+
+    auto it = m_Variants.find(mask);
+    if (it != m_Variants.end())
+        return &it->second;
+
+    auto pending = m_Pending.find(mask);
+    if (pending == m_Pending.end())
+    {
+        Submit(mask);
+        pending = m_Pending.find(mask);
+    }
+    if (!pending->second.IsReady())
+        return pending->second.Get();
+
+    // 编译完成：程序移入 m_Variants，之后的 Get 直接命中
+    Shader& shader = m_Variants.emplace(mask, std::move(*pending->second.Get())).first->second;
+    m_Pending.erase(pending);
+    return &shader;
+}
+
+void ShaderVariants::Prewarm(const std::vector<unsigned int>& masks)
+{
+    std::vector<unsigned int> missing;
+    for (unsigned int mask : masks)
+    {
+        mask = Canonical(mask);
+        if (m_Variants.find(mask) == m_Variants.end() && m_Pending.find(mask) == m_Pending.end()
+            && std::find(missing.begin(), missing.end(), mask) == missing.end())
+            missing.push_back(mask);
+    }
+    if (!missing.empty())
+        Build(missing);
+}
+
+void ShaderVariants::Reload()
+{
+    Build(GetCompiledMasks());
+    // 还在编译的保持不变，失败的按新的源码重新提交
+    std::vector<unsigned int> failed;
+    for (const auto& pair : m_Pending)
+    {
+        if (pair.second.GetStatus() == ShaderStatus::Failed)
+            failed.push_back(pair.first);
+    }
+    for (unsigned int mask : failed)
+        Submit(mask);
+}
+
+std::vector<unsigned int> ShaderVariants::GetCompiledMasks() const
+{
+    std::vector<unsigned int> masks;
+    masks.reserve(m_Variants.size());
+    for (const auto& pair : m_Variants)
+        masks.push_back(pair.first);
+    return masks;
+}
+
+unsigned int ShaderVariants::Canonical(unsigned int mask) const
+{
+    if (m_Keywords.size() < MaxShaderKeywords)
+        mask &= (1u << m_Keywords.size()) - 1;
+    return mask;
+}
+
+std::string ShaderVariants::MakeDefines(unsigned int mask) const
+{
+    std::string defines;
+    for (size_t i = 0; i < m_Keywords.size(); i++)
+    {
+        if (mask & (1u << i))
+            defines.append("#define ").append(m_Keywords[i]).append(" 1\n");
+    }
+    return defines;
+}
+
+std::string ShaderVariants::MakeName(unsigned int mask) const
+{
+    std::string name = m_FilePath + " [";
+    for (size_t i = 0; i < m_Keywords.size(); i++)
+    {
+        if (mask & (1u << i))
+            name.append(name.back() == '[' ? "" : " ").append(m_Keywords[i]);
+    }
+    return name + "]";
+}
+
+void ShaderVariants::Build(const std::vector<unsigned int>& masks)
+{
+    // 所有变体共用一次解析；重新加载时关键字列表随文件更新
+    ShaderProgramSource source = Shader::ParseShader(m_FilePath);
+    m_Keywords.assign(source.Keywords.begin(), source.Keywords.end());
+
+    std::vector<std::pair<unsigned int, ProgramBuild>> builds;
+    builds.reserve(masks.size());
+    for (unsigned int mask : masks)
+        builds.emplace_back(mask, Shader::StartBuild(source, MakeDefines(mask)));
+
+    for (auto& pair : builds)
+    {
+        // 链接失败的程序不能使用：新变体不加入，下次 Get 重新提交或返回后备程序；已有的变体保留旧程序
+        if (!Shader::FinishBuild(pair.second, MakeName(pair.first)))
+        {
+            DeletionQueue::DeleteProgram(pair.second.Program);
+            continue;
+        }
+        auto it = m_Variants.find(pair.first);
+        if (it == m_Variants.end())
+            m_Variants.emplace(pair.first, Shader(m_FilePath, pair.second.Program));
+        else
+            it->second = Shader(m_FilePath, pair.second.Program);
+    }
+}
+
+void ShaderVariants::Submit(unsigned int mask)
+{
+    ShaderProgramSource source = Shader::ParseShader(m_FilePath);
+    m_Pending[mask] = ShaderCompiler::Submit(m_FilePath, source, MakeDefines(mask), MakeName(mask), m_Fallback);
+}
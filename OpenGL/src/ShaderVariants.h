@@ -0,0 +1,57 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+#include "ShaderCompiler.h"
+
+// 一个 .shader 文件的所有变体。文件在第一条 #shader 之前用 "#keywords FOG NORMAL_MAP ..." 声明关键字，
+// 第 i 个关键字对应掩码的第 i 位；掩码中置位的关键字以 "#define 名字 1" 插在每个阶段的 #version 之后，
+// 没置位的不定义，GLSL 中用 #ifdef 剔除不需要的分支。
+// 每个掩码在第一次 Get 时交给 ShaderCompiler 异步编译，完成前返回后备程序；
+// 变体的二进制各自按宏定义进入 ProgramBinaryCache
+class ShaderVariants
+{
+private:
+    std::string m_FilePath;
+    std::vector<std::string> m_Keywords;
+    std::unordered_map<unsigned int, Shader> m_Variants; // 节点不会移动，Get 返回的指针一直有效
+    std::unordered_map<unsigned int, ShaderFuture> m_Pending; // 还在编译或编译失败的变体
+    std::vector<unsigned int> m_Requested; // 通过 Get 请求过的掩码，写入清单
+    Shader* m_Fallback;
+public:
+    explicit ShaderVariants(const std::string& filepath);
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // 未声明的关键字不设置任何位，并打印警告
+    unsigned int GetMask(std::string_view keyword) const;
+    unsigned int GetMask(std::initializer_list<std::string_view> keywords) const;
+
+    // 编译完成前（包括失败时）返回后备程序，可能为 nullptr；完成由 ShaderCompiler::Poll 推进
+    Shader* Get(unsigned int mask);
+    // 未设置时使用 ShaderCompiler 的默认后备程序
+    inline void SetFallback(Shader* fallback) { m_Fallback = fallback; }
+    // 同步编译：先为所有还没编译的掩码发出编译命令，再依次取结果；驱动支持并行编译时这些变体同时编译。
+    // 只预热不算请求，不会写入清单
+    void Prewarm(const std::vector<unsigned int>& masks);
+    // 重新构建所有已经编译过的变体，失败的保留旧程序；编译失败的变体重新提交
+    void Reload();
+
+    inline const std::string& GetFilePath() const { return m_FilePath; }
+    inline const std::vector<std::string>& GetKeywords() const { return m_Keywords; }
+    // 已经编译过的掩码
+    std::vector<unsigned int> GetCompiledMasks() const;
+    inline const std::vector<unsigned int>& GetRequestedMasks() const { return m_Requested; }
+private:
+    // 去掉没有对应关键字的位，保证同一组合只有一个键
+    unsigned int Canonical(unsigned int mask) const;
+    std::string MakeDefines(unsigned int mask) const;
+    std::string MakeName(unsigned int mask) const;
+    void Build(const std::vector<unsigned int>& masks);
+    void Submit(unsigned int mask);
+};
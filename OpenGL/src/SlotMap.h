@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// 32 位代际句柄：低 20 位是槽位下标，高 12 位是代数。值为 0 的句柄无效
+template<typename T>
+struct Handle
+{
+    static const uint32_t IndexBits = 20;
+    static const uint32_t IndexMask = (1u << IndexBits) - 1;
+    static const uint32_t MaxGeneration = (1u << (32 - IndexBits)) - 1;
+
+    uint32_t Value = 0;
+
+    inline uint32_t GetIndex() const { return Value & IndexMask; }
+    inline uint32_t GetGeneration() const { return Value >> IndexBits; }
+    inline bool IsValid() const { return Value != 0; }
+    inline bool operator==(const Handle& other) const { return Value == other.Value; }
+    inline bool operator!=(const Handle& other) const { return Value != other.Value; }
+};
+
+// 稠密槽位表：对象连续存放在 m_Dense 中，句柄经过一次 m_Slots 下标找到对象。
+// 删除时把最后一个对象移到空位（所以 T 只需要可移动），槽位的代数加一，旧句柄随即失效。
+// Get 返回的指针在下一次 Emplace / Remove 之前有效
+template<typename T>
+class SlotMap
+{
+private:
+    static const uint32_t Invalid = 0xFFFFFFFF;
+
+    struct Slot
+    {
+        uint32_t DenseIndex; // 空闲时为下一个空闲槽位
+        uint32_t Generation;
+    };
+
+    std::vector<T> m_Dense;
+    std::vector<uint32_t> m_DenseToSlot;
+    std::vector<Slot> m_Slots;
+    uint32_t m_FreeHead = Invalid;
+public:
+    template<typename... Args>
+    Handle<T> Emplace(Args&&... args)
+    {
+        uint32_t slot = m_FreeHead;
+        if (slot != Invalid)
+        {
+            m_FreeHead = m_Slots[slot].DenseIndex;
+        }
+        else
+        {
+            slot = (uint32_t)m_Slots.size();
+            if (slot > Handle<T>::IndexMask)
+                return Handle<T>();
+            m_Slots.push_back({ Invalid, 1 });
+        }
+
+        m_Slots[slot].DenseIndex = (uint32_t)m_Dense.size();
+        m_Dense.emplace_back(std::forward<Args>(args)...);
+        m_DenseToSlot.push_back(slot);
+
+        Handle<T> handle;
+        handle.Value = (m_Slots[slot].Generation << Handle<T>::IndexBits) | slot;
+        return handle;
+    }
+
+    bool Remove(Handle<T> handle)
+    {
+        if (!Contains(handle))
+            return false;
+
+        uint32_t slot = handle.GetIndex();
+        uint32_t index = m_Slots[slot].DenseIndex;
+        uint32_t last = (uint32_t)m_Dense.size() - 1;
+        if (index != last)
+        {
+            // 移动赋值会先释放被删除对象持有的资源
+            m_Dense[index] = std::move(m_Dense[last]);
+            m_DenseToSlot[index] = m_DenseToSlot[last];
+            m_Slots[m_DenseToSlot[index]].DenseIndex = index;
+        }
+        m_Dense.pop_back();
+        m_DenseToSlot.pop_back();
+
+        // 代数回绕时跳过 0，保证句柄值不为 0
+        uint32_t generation = m_Slots[slot].Generation + 1;
+        m_Slots[slot].Generation = generation > Handle<T>::MaxGeneration ? 1 : generation;
+        m_Slots[slot].DenseIndex = m_FreeHead;
+        m_FreeHead = slot;
+        return true;
+    }
+
+    inline bool Contains(Handle<T> handle) const
+    {
+        uint32_t slot = handle.GetIndex();
+        return handle.IsValid() && slot < m_Slots.size() && m_Slots[slot].Generation == handle.GetGeneration();
+    }
+
+    // 句柄过期或无效时返回 nullptr
+    inline T* Get(Handle<T> handle)
+    {
+        return Contains(handle) ? &m_Dense[m_Slots[handle.GetIndex()].DenseIndex] : nullptr;
+    }
+
+    inline const T* Get(Handle<T> handle) const
+    {
+        return Contains(handle) ? &m_Dense[m_Slots[handle.GetIndex()].DenseIndex] : nullptr;
+    }
+
+    void Clear()
+    {
+        while (!m_Dense.empty())
+        {
+            Handle<T> handle;
+            uint32_t slot = m_DenseToSlot.back();
+            handle.Value = (m_Slots[slot].Generation << Handle<T>::IndexBits) | slot;
+            Remove(handle);
+        }
+    }
+
+    inline size_t Size() const { return m_Dense.size(); }
+    inline bool Empty() const { return m_Dense.empty(); }
+
+    // 按存放顺序遍历所有对象
+    inline typename std::vector<T>::iterator begin() { return m_Dense.begin(); }
+    inline typename std::vector<T>::iterator end() { return m_Dense.end(); }
+    inline typename std::vector<T>::const_iterator begin() const { return m_Dense.begin(); }
+    inline typename std::vector<T>::const_iterator end() const { return m_Dense.end(); }
+};
@@ -0,0 +1,185 @@
+#include "StreamBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "GLCaps.h"
+
+namespace
+{
+    const GLbitfield PersistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+}
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount)
+    : m_Target(target), m_RendererID(0), m_RegionSize(regionSize),
+      m_RegionCount(regionCount < MaxRegions ? regionCount : MaxRegions),
+      m_Region(0), m_Head(0), m_Reserved(0), m_Mapped(false), m_Memory(nullptr), m_FenceWaits(0)
+{
+    for (GLsync& fence : m_Fences)
+        fence = nullptr;
+
+    m_Persistent = GLCaps::Get().BufferStorage;
+    unsigned int size = m_RegionSize * m_RegionCount;
+
+    m_RendererID = DeletionQueue::AcquireBuffer();
+    bool dsa = GLCaps::HasDirectStateAccess();
+    if (m_Persistent)
+    {
+        if (dsa)
+        {
+            GLCall(glNamedBufferStorage(m_RendererID, size, nullptr, PersistentFlags));
+            GLCall(m_Memory = (unsigned char*)glMapNamedBufferRange(m_RendererID, 0, size, PersistentFlags));
+        }
+        else
+        {
+            GLState::BindBuffer(m_Target, m_RendererID);
+            GLCall(glBufferStorage(m_Target, size, nullptr, PersistentFlags));
+            GLCall(m_Memory = (unsigned char*)glMapBufferRange(m_Target, 0, size, PersistentFlags));
+        }
+        if (!m_Memory)
+        {
+            // 不可变存储不能再用 glBufferData 重新分配，换一个名字走回退路径
+            DeletionQueue::DeleteBuffer(m_RendererID, false);
+            m_RendererID = DeletionQueue::AcquireBuffer();
+            m_Persistent = false;
+        }
+    }
+    if (m_Persistent)
+        return;
+
+    if (dsa)
+    {
+        GLCall(glNamedBufferData(m_RendererID, size, nullptr, GL_STREAM_DRAW));
+    }
+    else
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        GLCall(glBufferData(m_Target, size, nullptr, GL_STREAM_DRAW));
+    }
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (GLsync& fence : m_Fences)
+    {
+        if (fence)
+        {
+            GLCall(glDeleteSync(fence));
+        }
+    }
+    if ((m_Persistent || m_Mapped) && GLCaps::HasDirectStateAccess())
+    {
+        GLCall(glUnmapNamedBuffer(m_RendererID));
+    }
+    else if (m_Persistent || m_Mapped)
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        GLCall(glUnmapBuffer(m_Target));
+    }
+    // 可能是 glBufferStorage 分配的不可变存储，不能缩小，名字不回收
+    DeletionQueue::DeleteBuffer(m_RendererID, false);
+}
+
+void* StreamBuffer::Map(unsigned int maxSize, unsigned int alignment)
+{
+    ASSERT(!m_Mapped && maxSize <= m_RegionSize);
+
+    unsigned int aligned = (m_Head + alignment - 1) / alignment * alignment;
+    if (m_Persistent)
+    {
+        // 当前区域放不下时提前切换区域（相当于多插入一个栅栏）
+        if (aligned + maxSize > (m_Region + 1) * m_RegionSize)
+        {
+            NextRegion();
+            aligned = (m_Head + alignment - 1) / alignment * alignment;
+        }
+        m_Reserved = aligned;
+        m_Mapped = true;
+        return m_Memory + aligned;
+    }
+
+    // 回退路径：写到末尾后孤立整块缓冲，由驱动分配新的存储，不必等待 GPU
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+    bool orphan = aligned + maxSize > m_RegionSize * m_RegionCount;
+    if (orphan)
+        aligned = 0;
+    void* memory = nullptr;
+    if (GLCaps::HasDirectStateAccess())
+    {
+        if (orphan)
+        {
+            GLCall(glNamedBufferData(m_RendererID, m_RegionSize * m_RegionCount, nullptr, GL_STREAM_DRAW));
+        }
+        GLCall(memory = glMapNamedBufferRange(m_RendererID, aligned, maxSize, access));
+    }
+    else
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        if (orphan)
+        {
+            GLCall(glBufferData(m_Target, m_RegionSize * m_RegionCount, nullptr, GL_STREAM_DRAW));
+        }
+        GLCall(memory = glMapBufferRange(m_Target, aligned, maxSize, access));
+    }
+    m_Reserved = aligned;
+    m_Mapped = true;
+    return memory;
+}
+
+unsigned int StreamBuffer::Unmap(unsigned int usedSize)
+{
+    ASSERT(m_Mapped);
+    if (!m_Persistent && GLCaps::HasDirectStateAccess())
+    {
+        if (usedSize > 0)
+        {
+            GLCall(glFlushMappedNamedBufferRange(m_RendererID, 0, usedSize));
+        }
+        GLCall(glUnmapNamedBuffer(m_RendererID));
+    }
+    else if (!m_Persistent)
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        if (usedSize > 0)
+        {
+            GLCall(glFlushMappedBufferRange(m_Target, 0, usedSize));
+        }
+        GLCall(glUnmapBuffer(m_Target));
+    }
+    m_Mapped = false;
+    m_Head = m_Reserved + usedSize;
+    return m_Reserved;
+}
+
+void StreamBuffer::EndFrame()
+{
+    if (m_Persistent)
+        NextRegion();
+}
+
+void StreamBuffer::NextRegion()
+{
+    GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    m_Region = (m_Region + 1) % m_RegionCount;
+    m_Head = m_Region * m_RegionSize;
+
+    // 等待 GPU 用完这个区域上一次写入的数据
+    GLsync fence = m_Fences[m_Region];
+    if (!fence)
+        return;
+    GLCall(GLenum result = glClientWaitSync(fence, 0, 0));
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        m_FenceWaits++;
+        do
+        {
+            GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    GLCall(glDeleteSync(fence));
+    m_Fences[m_Region] = nullptr;
+}
+
+void StreamBuffer::Bind() const
+{
+    GLState::BindBuffer(m_Target, m_RendererID);
+}
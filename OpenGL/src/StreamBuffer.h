@@ -0,0 +1,46 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// 流式顶点缓冲：优先用 glBufferStorage 持久/一致映射，按帧分成若干区域并用栅栏保护，
+// CPU 直接写入 GPU 可见的内存；不支持 ARB_buffer_storage 时退回到孤立（orphan）+ glMapBufferRange。
+// 支持 DSA 时创建、映射和孤立都不改变绑定
+class StreamBuffer
+{
+public:
+    static const unsigned int MaxRegions = 4;
+private:
+    unsigned int m_Target;
+    unsigned int m_RendererID;
+    unsigned int m_RegionSize;
+    unsigned int m_RegionCount;
+    unsigned int m_Region;     // 当前写入的区域
+    unsigned int m_Head;       // 在整个缓冲中的写入位置
+    unsigned int m_Reserved;   // Map 返回的位置
+    bool m_Persistent;
+    bool m_Mapped;
+    unsigned char* m_Memory;   // 持久映射的起始地址
+    GLsync m_Fences[MaxRegions];
+    unsigned int m_FenceWaits;
+public:
+    StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount = 3);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // 预留最多 maxSize 字节并返回写入地址，起始偏移按 alignment 对齐
+    void* Map(unsigned int maxSize, unsigned int alignment = 4);
+    // 提交实际写入的 usedSize 字节，返回这段数据在缓冲中的字节偏移
+    unsigned int Unmap(unsigned int usedSize);
+    // 每帧结束时调用：为当前区域插入栅栏并切换到下一个区域
+    void EndFrame();
+
+    void Bind() const;
+
+    inline unsigned int GetRendererID() const { return m_RendererID; }
+    inline bool IsPersistent() const { return m_Persistent; }
+    inline unsigned int GetFenceWaits() const { return m_FenceWaits; }
+private:
+    void NextRegion();
+};
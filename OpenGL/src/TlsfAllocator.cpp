@@ -0,0 +1,213 @@
+#include "TlsfAllocator.h"
+#include "Renderer.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    unsigned int LowestBit(unsigned int value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return index;
+#else
+        return __builtin_ctz(value);
+#endif
+    }
+
+    unsigned int HighestBit(unsigned int value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse(&index, value);
+        return index;
+#else
+        return 31 - __builtin_clz(value);
+#endif
+    }
+}
+
+TlsfAllocator::TlsfAllocator(unsigned int capacity)
+    : m_FLBitmap(0), m_Capacity(capacity), m_UsedBytes(0), m_AllocationCount(0)
+{
+    for (unsigned int fl = 0; fl < FLCount; fl++)
+    {
+        m_SLBitmap[fl] = 0;
+        for (unsigned int sl = 0; sl < SLCount; sl++)
+            m_FreeHeads[fl][sl] = Invalid;
+    }
+    if (capacity > 0)
+        InsertFree(NewBlock(0, capacity, Invalid, Invalid));
+}
+
+void TlsfAllocator::Mapping(unsigned int size, unsigned int& fl, unsigned int& sl)
+{
+    if (size < SLCount)
+    {
+        fl = 0;
+        sl = size;
+        return;
+    }
+    unsigned int msb = HighestBit(size);
+    fl = msb - SLBits + 1;
+    sl = (size >> (msb - SLBits)) & (SLCount - 1);
+}
+
+unsigned int TlsfAllocator::FindFree(unsigned int size) const
+{
+    // 向上取整到下一个二级档位，保证找到的链表里任何一块都够大
+    if (size >= SLCount)
+    {
+        unsigned int round = (1u << (HighestBit(size) - SLBits)) - 1;
+        if (size > 0xFFFFFFFF - round)
+            return Invalid;
+        size += round;
+    }
+    unsigned int fl, sl;
+    Mapping(size, fl, sl);
+
+    unsigned int slMap = m_SLBitmap[fl] & (0xFFFFFFFF << sl);
+    if (slMap == 0)
+    {
+        unsigned int flMap = fl + 1 < 32 ? m_FLBitmap & (0xFFFFFFFF << (fl + 1)) : 0;
+        if (flMap == 0)
+            return Invalid;
+        fl = LowestBit(flMap);
+        slMap = m_SLBitmap[fl];
+    }
+    sl = LowestBit(slMap);
+    return m_FreeHeads[fl][sl];
+}
+
+unsigned int TlsfAllocator::NewBlock(unsigned int offset, unsigned int size, unsigned int prevPhys, unsigned int nextPhys)
+{
+    Block block = { offset, size, prevPhys, nextPhys, Invalid, Invalid, false };
+    if (!m_UnusedBlocks.empty())
+    {
+        unsigned int index = m_UnusedBlocks.back();
+        m_UnusedBlocks.pop_back();
+        m_Blocks[index] = block;
+        return index;
+    }
+    m_Blocks.push_back(block);
+    return (unsigned int)m_Blocks.size() - 1;
+}
+
+void TlsfAllocator::InsertFree(unsigned int index)
+{
+    Block& block = m_Blocks[index];
+    unsigned int fl, sl;
+    Mapping(block.Size, fl, sl);
+
+    block.Free = true;
+    block.PrevFree = Invalid;
+    block.NextFree = m_FreeHeads[fl][sl];
+    if (block.NextFree != Invalid)
+        m_Blocks[block.NextFree].PrevFree = index;
+    m_FreeHeads[fl][sl] = index;
+    m_FLBitmap |= 1u << fl;
+    m_SLBitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::RemoveFree(unsigned int index)
+{
+    Block& block = m_Blocks[index];
+    unsigned int fl, sl;
+    Mapping(block.Size, fl, sl);
+
+    if (block.PrevFree != Invalid)
+        m_Blocks[block.PrevFree].NextFree = block.NextFree;
+    else
+        m_FreeHeads[fl][sl] = block.NextFree;
+    if (block.NextFree != Invalid)
+        m_Blocks[block.NextFree].PrevFree = block.PrevFree;
+
+    if (m_FreeHeads[fl][sl] == Invalid)
+    {
+        m_SLBitmap[fl] &= ~(1u << sl);
+        if (m_SLBitmap[fl] == 0)
+            m_FLBitmap &= ~(1u << fl);
+    }
+    block.Free = false;
+    block.PrevFree = Invalid;
+    block.NextFree = Invalid;
+}
+
+unsigned int TlsfAllocator::Split(unsigned int index, unsigned int size)
+{
+    Block& block = m_Blocks[index];
+    unsigned int rest = NewBlock(block.Offset + size, block.Size - size, index, block.NextPhys);
+    // NewBlock 可能让 m_Blocks 重新分配，之后不能再用 block 引用
+    Block& first = m_Blocks[index];
+    if (first.NextPhys != Invalid)
+        m_Blocks[first.NextPhys].PrevPhys = rest;
+    first.NextPhys = rest;
+    first.Size = size;
+    InsertFree(rest);
+    return rest;
+}
+
+unsigned int TlsfAllocator::Allocate(unsigned int size, unsigned int alignment, unsigned int& offset)
+{
+    if (size == 0)
+        size = 1;
+    if (alignment == 0)
+        alignment = 1;
+
+    // 多找 alignment - 1 字节，保证对齐后仍然放得下
+    unsigned int index = FindFree(size + alignment - 1);
+    if (index == Invalid)
+        return Invalid;
+    RemoveFree(index);
+
+    // 对齐产生的前部空隙切出去作为独立的空闲块（它的前一个物理块一定已被占用，不需要合并）
+    unsigned int padding = (alignment - m_Blocks[index].Offset % alignment) % alignment;
+    if (padding > 0)
+    {
+        unsigned int aligned = Split(index, padding);
+        RemoveFree(aligned);
+        InsertFree(index);
+        index = aligned;
+    }
+    if (m_Blocks[index].Size - size >= MinBlockSize)
+        Split(index, size);
+
+    offset = m_Blocks[index].Offset;
+    m_UsedBytes += m_Blocks[index].Size;
+    m_AllocationCount++;
+    return index;
+}
+
+void TlsfAllocator::Free(unsigned int index)
+{
+    ASSERT(index < m_Blocks.size() && !m_Blocks[index].Free);
+    m_UsedBytes -= m_Blocks[index].Size;
+    m_AllocationCount--;
+
+    // 与物理相邻的空闲块合并，避免碎片
+    unsigned int next = m_Blocks[index].NextPhys;
+    if (next != Invalid && m_Blocks[next].Free)
+    {
+        RemoveFree(next);
+        m_Blocks[index].Size += m_Blocks[next].Size;
+        m_Blocks[index].NextPhys = m_Blocks[next].NextPhys;
+        if (m_Blocks[index].NextPhys != Invalid)
+            m_Blocks[m_Blocks[index].NextPhys].PrevPhys = index;
+        m_UnusedBlocks.push_back(next);
+    }
+    unsigned int prev = m_Blocks[index].PrevPhys;
+    if (prev != Invalid && m_Blocks[prev].Free)
+    {
+        RemoveFree(prev);
+        m_Blocks[prev].Size += m_Blocks[index].Size;
+        m_Blocks[prev].NextPhys = m_Blocks[index].NextPhys;
+        if (m_Blocks[prev].NextPhys != Invalid)
+            m_Blocks[m_Blocks[prev].NextPhys].PrevPhys = prev;
+        m_UnusedBlocks.push_back(index);
+        index = prev;
+    }
+    InsertFree(index);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+// TLSF（two-level segregated fit）区间分配器，只管理 [0, capacity) 内的偏移，不接触实际内存，
+// 所以可以用来切分 GPU 缓冲。分配和释放都是 O(1)：一级按 2 的幂分档，二级在每档内再线性分 16 份，
+// 两级各用一个位图记录哪些空闲链表非空；释放时与物理相邻的空闲块立即合并
+class TlsfAllocator
+{
+public:
+    static const unsigned int Invalid = 0xFFFFFFFF;
+    static const unsigned int SLBits = 4;
+    static const unsigned int SLCount = 1 << SLBits;
+    static const unsigned int FLCount = 32 - SLBits + 1;
+    static const unsigned int MinBlockSize = 16; // 剩余部分小于这个值时不再切分
+private:
+    struct Block
+    {
+        unsigned int Offset;
+        unsigned int Size;
+        unsigned int PrevPhys; // 物理上相邻的块
+        unsigned int NextPhys;
+        unsigned int PrevFree; // 同一空闲链表中的块
+        unsigned int NextFree;
+        bool Free;
+    };
+
+    std::vector<Block> m_Blocks;
+    std::vector<unsigned int> m_UnusedBlocks; // m_Blocks 中可复用的槽位
+    unsigned int m_FreeHeads[FLCount][SLCount];
+    unsigned int m_FLBitmap;
+    unsigned int m_SLBitmap[FLCount];
+    unsigned int m_Capacity;
+    unsigned int m_UsedBytes;
+    unsigned int m_AllocationCount;
+public:
+    TlsfAllocator(unsigned int capacity);
+
+    // 成功时返回块编号并把对齐后的起始偏移写入 offset，失败返回 Invalid
+    unsigned int Allocate(unsigned int size, unsigned int alignment, unsigned int& offset);
+    void Free(unsigned int block);
+
+    inline unsigned int GetCapacity() const { return m_Capacity; }
+    inline unsigned int GetUsedBytes() const { return m_UsedBytes; }
+    inline unsigned int GetAllocationCount() const { return m_AllocationCount; }
+private:
+    static void Mapping(unsigned int size, unsigned int& fl, unsigned int& sl);
+    unsigned int FindFree(unsigned int size) const;
+    unsigned int NewBlock(unsigned int offset, unsigned int size, unsigned int prevPhys, unsigned int nextPhys);
+    void InsertFree(unsigned int block);
+    void RemoveFree(unsigned int block);
+    // 把 block 从 size 处切开，后半部分作为新的空闲块，返回它的编号
+    unsigned int Split(unsigned int block, unsigned int size);
+};
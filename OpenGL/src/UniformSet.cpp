@@ -0,0 +1,113 @@
+#include "UniformSet.h"
+#include "Shader.h"
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    // unordered_set 的节点不会移动，元素地址在插入新名字后仍然有效
+    std::mutex s_NamesMutex;
+    std::unordered_set<std::string> s_Names;
+}
+
+const std::string* UniformSet::Intern(const std::string& name)
+{
+    // 命令缓冲在多个工作线程中录制，每个线程先查自己的缓存，只有新名字才加锁
+    thread_local std::unordered_map<std::string, const std::string*> cache;
+    auto it = cache.find(name);
+    if (it != cache.end())
+        return it->second;
+
+    std::lock_guard<std::mutex> lock(s_NamesMutex);
+    const std::string* interned = &*s_Names.insert(name).first;
+    cache.emplace(name, interned);
+    return interned;
+}
+
+UniformValue& UniformSet::FindOrAdd(const std::string& name, UniformType type)
+{
+    for (UniformValue& value : m_Values)
+    {
+        if (*value.Name == name)
+        {
+            value.Type = type;
+            return value;
+        }
+    }
+    m_Values.push_back({ Intern(name), type, 0, {} });
+    return m_Values.back();
+}
+
+void UniformSet::SetInt(const std::string& name, int value)
+{
+    FindOrAdd(name, UniformType::Int).IntValue = value;
+}
+
+void UniformSet::SetFloat(const std::string& name, float value)
+{
+    FindOrAdd(name, UniformType::Float).Values[0] = value;
+}
+
+void UniformSet::SetVec4(const std::string& name, float v0, float v1, float v2, float v3)
+{
+    UniformValue& value = FindOrAdd(name, UniformType::Vec4);
+    value.Values[0] = v0;
+    value.Values[1] = v1;
+    value.Values[2] = v2;
+    value.Values[3] = v3;
+}
+
+void UniformSet::SetMat4(const std::string& name, const float* matrix)
+{
+    std::memcpy(FindOrAdd(name, UniformType::Mat4).Values, matrix, 16 * sizeof(float));
+}
+
+void UniformSet::Apply(Shader& shader, const UniformValue* values, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const UniformValue& value = values[i];
+        switch (value.Type)
+        {
+        case UniformType::Int:
+            shader.SetUniform1i(*value.Name, value.IntValue);
+            break;
+        case UniformType::Float:
+            shader.SetUniform1f(*value.Name, value.Values[0]);
+            break;
+        case UniformType::Vec4:
+            shader.SetUniform4f(*value.Name, value.Values[0], value.Values[1], value.Values[2], value.Values[3]);
+            break;
+        case UniformType::Mat4:
+            shader.SetUniformMat4f(*value.Name, value.Values);
+            break;
+        }
+    }
+}
+
+unsigned long long UniformSet::Hash() const
+{
+    // FNV-1a，依次混入名字、类型和值
+    unsigned long long hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const UniformValue& value : m_Values)
+    {
+        mix(value.Name->data(), value.Name->size());
+        mix(&value.Type, sizeof(value.Type));
+        if (value.Type == UniformType::Int)
+            mix(&value.IntValue, sizeof(value.IntValue));
+        else
+            mix(value.Values, (value.Type == UniformType::Mat4 ? 16 : value.Type == UniformType::Vec4 ? 4 : 1) * sizeof(float));
+    }
+    return hash;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class Shader;
+
+enum class UniformType
+{
+    Int, Float, Vec4, Mat4
+};
+
+// 一个 uniform 值。名字经过 UniformSet::Intern，指针一直有效，整个结构可以直接复制
+struct UniformValue
+{
+    const std::string* Name;
+    UniformType Type;
+    int IntValue;
+    float Values[16];
+};
+
+// 一次绘制要设置的 uniform 值，提交到渲染队列时复制进渲染器每帧复用的数组
+class UniformSet
+{
+private:
+    std::vector<UniformValue> m_Values;
+public:
+    void SetInt(const std::string& name, int value);
+    void SetFloat(const std::string& name, float value);
+    void SetVec4(const std::string& name, float v0, float v1, float v2, float v3);
+    void SetMat4(const std::string& name, const float* matrix);
+
+    inline void Apply(Shader& shader) const { Apply(shader, m_Values.data(), m_Values.size()); }
+    // 内容相同的两组 uniform 哈希相同，用作排序键中的材质部分
+    unsigned long long Hash() const;
+
+    inline bool Empty() const { return m_Values.empty(); }
+    inline const std::vector<UniformValue>& GetValues() const { return m_Values; }
+
+    static void Apply(Shader& shader, const UniformValue* values, size_t count);
+    // 相同的名字返回同一个指针，可以在任意线程调用
+    static const std::string* Intern(const std::string& name);
+private:
+    UniformValue& FindOrAdd(const std::string& name, UniformType type);
+};
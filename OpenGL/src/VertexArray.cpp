@@ -2,42 +2,211 @@
 #include "VertexBufferLayout.h"
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "GLCaps.h"
+#include "StreamBuffer.h"
 
 
 
-VertexArray::VertexArray()
+VertexArray::VertexArray() : m_AttribCount(0), m_BindingCount(0)
 {
+    if (GLCaps::HasDirectStateAccess())
+    {
+        GLCall(glCreateVertexArrays(1, &m_RendererID));
+        return;
+    }
     GLCall(glGenVertexArrays(1, &m_RendererID));
-    GLCall(glBindVertexArray(m_RendererID));
+    GLState::BindVertexArray(m_RendererID);
 }
 
 VertexArray::~VertexArray()
 {
-    GLCall(glDeleteVertexArrays(1, &m_RendererID));
+    Release();
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_AttribCount(other.m_AttribCount), m_BindingCount(other.m_BindingCount),
+      m_Formats(std::move(other.m_Formats))
+{
+    other.m_RendererID = 0;
+    other.m_AttribCount = 0;
+    other.m_BindingCount = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_RendererID = other.m_RendererID;
+        m_AttribCount = other.m_AttribCount;
+        m_BindingCount = other.m_BindingCount;
+        m_Formats = std::move(other.m_Formats);
+        other.m_RendererID = 0;
+        other.m_AttribCount = 0;
+        other.m_BindingCount = 0;
+    }
+    return *this;
+}
+
+void VertexArray::Release()
+{
+    if (m_RendererID == 0)
+        return;
+    DeletionQueue::DeleteVertexArray(m_RendererID);
+    m_RendererID = 0;
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
+    ASSERT(m_Formats.empty());
+    if (GLCaps::HasDirectStateAccess())
+    {
+        unsigned int binding = AttachBuffer(vb.GetRendererID(), layout.GetStride(), layout.GetInstanceDivisor());
+        m_AttribCount = SpecifyAttributes(layout, m_AttribCount, binding);
+        return;
+    }
     Bind();
     vb.Bind();
+    m_AttribCount = SpecifyAttributes(layout, m_AttribCount);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout)
+{
+    ASSERT(m_Formats.empty());
+    if (GLCaps::HasDirectStateAccess())
+    {
+        unsigned int binding = AttachBuffer(sb.GetRendererID(), layout.GetStride(), layout.GetInstanceDivisor());
+        m_AttribCount = SpecifyAttributes(layout, m_AttribCount, binding);
+        return;
+    }
+    Bind();
+    sb.Bind();
+    m_AttribCount = SpecifyAttributes(layout, m_AttribCount);
+}
+
+unsigned int VertexArray::AddFormat(const VertexBufferLayout& layout)
+{
+    ASSERT(m_AttribCount == 0 || !m_Formats.empty());
+    unsigned int binding = m_BindingCount++;
+    unsigned int firstLocation = m_AttribCount;
+    const GLCapabilities& caps = GLCaps::Get();
+    if (caps.DirectStateAccess)
+    {
+        m_AttribCount = SpecifyAttributes(layout, firstLocation, binding);
+        if (layout.GetInstanceDivisor() != 0)
+        {
+            GLCall(glVertexArrayBindingDivisor(m_RendererID, binding, layout.GetInstanceDivisor()));
+        }
+    }
+    else if (caps.VertexAttribBinding)
+    {
+        Bind();
+        m_AttribCount = SpecifyAttributes(layout, firstLocation, binding);
+        if (layout.GetInstanceDivisor() != 0)
+        {
+            GLCall(glVertexBindingDivisor(binding, layout.GetInstanceDivisor()));
+        }
+    }
+    else
+    {
+        // 没有独立的格式状态，位置先占下来，属性指针在 BindVertexBuffer 时设置
+        unsigned int locations = 0;
+        for (const VertexBufferElement& element : layout.GetElements())
+            locations += (element.count + 3) / 4;
+        m_AttribCount += locations;
+    }
+    m_Formats.push_back({ layout, firstLocation });
+    return binding;
+}
+
+void VertexArray::BindVertexBuffer(unsigned int binding, const VertexBuffer& vb) const
+{
+    ASSERT(binding < m_Formats.size());
+    const FormatBinding& format = m_Formats[binding];
+    unsigned int stride = format.Layout.GetStride();
+    const GLCapabilities& caps = GLCaps::Get();
+    if (caps.DirectStateAccess)
+    {
+        GLCall(glVertexArrayVertexBuffer(m_RendererID, binding, vb.GetRendererID(), vb.GetOffset(), stride));
+    }
+    else if (caps.VertexAttribBinding)
+    {
+        Bind();
+        GLCall(glBindVertexBuffer(binding, vb.GetRendererID(), vb.GetOffset(), stride));
+    }
+    else
+    {
+        Bind();
+        vb.Bind();
+        SpecifyAttributes(format.Layout, format.FirstLocation, NoBinding, vb.GetOffset());
+    }
+}
+
+unsigned int VertexArray::AttachBuffer(unsigned int buffer, unsigned int stride, unsigned int divisor)
+{
+    unsigned int binding = m_BindingCount++;
+    GLCall(glVertexArrayVertexBuffer(m_RendererID, binding, buffer, 0, stride));
+    if (divisor != 0)
+    {
+        GLCall(glVertexArrayBindingDivisor(m_RendererID, binding, divisor));
+    }
+    return binding;
+}
+
+unsigned int VertexArray::SpecifyAttributes(const VertexBufferLayout& layout, unsigned int firstLocation,
+    unsigned int binding, unsigned int baseOffset) const
+{
+    bool dsa = GLCaps::HasDirectStateAccess();
     const auto& elements = layout.GetElements();
+    unsigned int location = firstLocation;
     unsigned int offset = 0;
     for (unsigned int i = 0; i < elements.size(); i++)
     {
         const auto& element = elements[i];
-        GLCall(glEnableVertexAttribArray(i));
-        GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized , layout.GetStride(), (const void*)offset));
-        offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+        // 属性位置接着之前加入的缓冲继续分配；超过 4 个分量的元素（如 mat4）占用多个连续位置
+        unsigned int remaining = element.count;
+        while (remaining > 0)
+        {
+            unsigned int count = remaining < 4 ? remaining : 4;
+            if (binding == NoBinding)
+            {
+                GLCall(glEnableVertexAttribArray(location));
+                GLCall(glVertexAttribPointer(location, count, element.type, element.normalized, layout.GetStride(),
+                    (const void*)(uintptr_t)(baseOffset + offset)));
+                if (layout.GetInstanceDivisor() != 0)
+                {
+                    GLCall(glVertexAttribDivisor(location, layout.GetInstanceDivisor()));
+                }
+            }
+            else if (dsa)
+            {
+                GLCall(glEnableVertexArrayAttrib(m_RendererID, location));
+                GLCall(glVertexArrayAttribFormat(m_RendererID, location, count, element.type, element.normalized, offset));
+                GLCall(glVertexArrayAttribBinding(m_RendererID, location, binding));
+            }
+            else
+            {
+                GLCall(glEnableVertexAttribArray(location));
+                GLCall(glVertexAttribFormat(location, count, element.type, element.normalized, offset));
+                GLCall(glVertexAttribBinding(location, binding));
+            }
+            offset += VertexBufferElement::GetSize(element.type, count);
+            remaining -= count;
+            location++;
+        }
     }
+    return location;
 }
 
 void VertexArray::Bind() const
 {
-    GLCall(glBindVertexArray(m_RendererID));
+    GLState::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-    GLCall(glBindVertexArray(0));
+    GLState::BindVertexArray(0);
 }
 
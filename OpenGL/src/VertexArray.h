@@ -2,18 +2,78 @@
 
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "VertexLayout.h"
+#include "GLCaps.h"
+#include <vector>
+
+class StreamBuffer;
 
 class VertexArray
 {
 private:
     unsigned int m_RendererID;
+    unsigned int m_AttribCount;
+    unsigned int m_BindingCount; // 已使用的缓冲绑定点数
+
+    // AddFormat 创建的绑定点：不支持 ARB_vertex_attrib_binding 时切换缓冲要按布局重新设置属性指针
+    struct FormatBinding
+    {
+        VertexBufferLayout Layout;
+        unsigned int FirstLocation;
+    };
+    std::vector<FormatBinding> m_Formats;
 
 public:
 	VertexArray();
     ~VertexArray();
 
+    VertexArray(const VertexArray&) = delete;
+    VertexArray& operator=(const VertexArray&) = delete;
+    VertexArray(VertexArray&& other) noexcept;
+    VertexArray& operator=(VertexArray&& other) noexcept;
+
+	// 属性指针总是从 GL 缓冲的起点开始；vb 来自 BufferPool 时，同一页里布局相同的网格都可以
+	// 共用这个 VAO，绘制时传入各自的 vb.GetBaseVertex(stride)
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	void AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout);
+
+	// 只描述顶点格式、不关联缓冲，返回绑定点序号；之后每个网格只需 BindVertexBuffer 切换缓冲，
+	// 布局相同的网格共用一个 VAO（见 VertexArrayCache）。同一个 VAO 不能与 AddBuffer 混用
+	unsigned int AddFormat(const VertexBufferLayout& layout);
+	// 把 vb 挂到 AddFormat 返回的绑定点上。绑定从 vb 自己的起点开始（池中的缓冲也一样），
+	// 所以绘制时 baseVertex 为 0
+	void BindVertexBuffer(unsigned int binding, const VertexBuffer& vb) const;
+
+	// 编译期布局（见 VertexLayout.h），source 可以是 VertexBuffer 或 StreamBuffer
+	template<typename Layout, typename Source>
+	void AddBuffer(const Source& source, unsigned int divisor = 0)
+	{
+		ASSERT(m_Formats.empty());
+		if (GLCaps::HasDirectStateAccess())
+		{
+			unsigned int binding = AttachBuffer(source.GetRendererID(), Layout::Stride, divisor);
+			m_AttribCount = Layout::ApplyFormat(m_RendererID, m_AttribCount, binding);
+			return;
+		}
+		Bind();
+		source.Bind();
+		m_AttribCount = Layout::Apply(m_AttribCount, divisor);
+	}
     void Bind() const;
     void Unbind() const;
+
+    inline unsigned int GetRendererID() const { return m_RendererID; }
+    inline unsigned int GetAttribCount() const { return m_AttribCount; }
+private:
+    static const unsigned int NoBinding = 0xFFFFFFFF;
+
+    // DSA 路径：把缓冲挂到一个新的绑定点，返回绑定点序号
+    unsigned int AttachBuffer(unsigned int buffer, unsigned int stride, unsigned int divisor);
+    // 从 firstLocation 开始设置 layout 的属性，返回下一个可用的位置。
+    // binding 为 NoBinding 时用当前绑定的 VAO 和 GL_ARRAY_BUFFER 设置属性指针（从 baseOffset 开始），
+    // 否则只设置格式并关联到 binding（非 DSA 时需要先绑定 VAO）
+    unsigned int SpecifyAttributes(const VertexBufferLayout& layout, unsigned int firstLocation,
+        unsigned int binding = NoBinding, unsigned int baseOffset = 0) const;
+    void Release();
 };
 
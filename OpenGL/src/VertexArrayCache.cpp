@@ -0,0 +1,25 @@
+#include "VertexArrayCache.h"
+#include "Renderer.h"
+
+const VertexArray& VertexArrayCache::Get(const VertexBufferLayout& layout)
+{
+    unsigned long long hash = layout.Hash();
+    auto it = m_Entries.find(hash);
+    if (it != m_Entries.end())
+    {
+        // 64 位哈希冲突几乎不可能，这里只做检查
+        ASSERT(it->second.Layout == layout);
+        m_Hits++;
+        return it->second.Format;
+    }
+
+    m_Misses++;
+    Entry& entry = m_Entries.emplace(hash, Entry{ layout, VertexArray() }).first->second;
+    entry.Format.AddFormat(layout);
+    return entry.Format;
+}
+
+void VertexArrayCache::Clear()
+{
+    m_Entries.clear();
+}
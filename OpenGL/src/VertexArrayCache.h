@@ -0,0 +1,35 @@
+#pragma once
+
+#include <unordered_map>
+#include "VertexArray.h"
+
+// 按布局哈希缓存只含格式的 VAO：布局相同的网格共用一个 VAO，绘制前用 BindVertexBuffer(0, vb) 切换缓冲。
+//
+//     const VertexArray& format = cache.Get(layout);
+//     renderer.Submit(format, meshVertices, meshIndices, shader);
+class VertexArrayCache
+{
+private:
+    struct Entry
+    {
+        VertexBufferLayout Layout;
+        VertexArray Format;
+    };
+
+    // unordered_map 的节点地址不随插入改变，Get 返回的引用一直有效，直到 Clear
+    std::unordered_map<unsigned long long, Entry> m_Entries;
+    unsigned int m_Hits;
+    unsigned int m_Misses;
+public:
+    VertexArrayCache() : m_Hits(0), m_Misses(0) {}
+    VertexArrayCache(const VertexArrayCache&) = delete;
+    VertexArrayCache& operator=(const VertexArrayCache&) = delete;
+
+    // 返回 layout 对应的 VAO，只有一个绑定点 0；第一次遇到这个布局时创建
+    const VertexArray& Get(const VertexBufferLayout& layout);
+    void Clear();
+
+    inline size_t Size() const { return m_Entries.size(); }
+    inline unsigned int GetHits() const { return m_Hits; }
+    inline unsigned int GetMisses() const { return m_Misses; }
+};
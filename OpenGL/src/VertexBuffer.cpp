@@ -1,25 +1,19 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "BufferPool.h"
 
 
-VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, BufferUsage usage)
+    : Buffer(GL_ARRAY_BUFFER, data, size, usage)
 {
-    GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
-    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
 }
 
-VertexBuffer::~VertexBuffer()
+VertexBuffer::VertexBuffer(unsigned int size, BufferUsage usage)
+    : Buffer(GL_ARRAY_BUFFER, nullptr, size, usage)
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
-void VertexBuffer::Bind() const
+VertexBuffer::VertexBuffer(BufferPool& pool, const void* data, unsigned int size, unsigned int stride, BufferUsage usage)
+    : Buffer(pool, data, size, stride, usage)
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
-}
-
-void VertexBuffer::Unbind() const
-{
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
 }
@@ -1,13 +1,15 @@
 #pragma once
-class VertexBuffer
+
+#include "Buffer.h"
+
+class VertexBuffer : public Buffer
 {
-private:
-    unsigned int m_RendererID;
 public:
-    VertexBuffer(const void* data, unsigned int size);
-    ~VertexBuffer();
+    VertexBuffer(const void* data, unsigned int size, BufferUsage usage = BufferUsage::Static);
+    // 只分配 size 字节，内容之后用 SetSubData / Write + Upload 填充
+    VertexBuffer(unsigned int size, BufferUsage usage = BufferUsage::Dynamic);
+    // 从 pool 中分配，起始偏移按顶点步长对齐，绘制时用 GetBaseVertex 作为 baseVertex
+    VertexBuffer(BufferPool& pool, const void* data, unsigned int size, unsigned int stride, BufferUsage usage = BufferUsage::Static);
 
-    void Bind() const;
-    void Unbind() const;
+    inline int GetBaseVertex(unsigned int stride) const { return (int)(m_Offset / stride); }
 };
-
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "Renderer.h"
+#include "VertexTypes.h"
 
 struct VertexBufferElement
 {
@@ -16,10 +17,22 @@ struct VertexBufferElement
         case GL_FLOAT: return 4;
         case GL_UNSIGNED_INT: return 4;
         case GL_UNSIGNED_BYTE: return 1;
+        case GL_HALF_FLOAT: return 2;
+        case GL_SHORT: return 2;
+        case GL_UNSIGNED_SHORT: return 2;
+        case GL_INT_2_10_10_10_REV: return 4; // 4 个分量打包在一起
         }
         ASSERT(false);
         return 0;
     }
+
+    // count 个分量占用的字节数，打包格式的 4 个分量共用一个 32 位整数
+    static unsigned int GetSize(unsigned int type, unsigned int count)
+    {
+        if (type == GL_INT_2_10_10_10_REV)
+            return GetSizeOfType(type);
+        return count * GetSizeOfType(type);
+    }
 };
 
 class VertexBufferLayout
@@ -27,9 +40,16 @@ class VertexBufferLayout
 private:
     std::vector<VertexBufferElement> m_Elements;
     unsigned int m_Stride;
+    unsigned int m_Divisor;
 public:
-	VertexBufferLayout() : m_Stride(0)
+	VertexBufferLayout() : m_Stride(0), m_Divisor(0)
+    {
+    }
+
+    // 非 0 时该缓冲中的属性按实例推进（每 divisor 个实例取下一项）
+    inline void SetInstanceDivisor(unsigned int divisor)
     {
+        m_Divisor = divisor;
     }
 
     template<typename T>
@@ -59,7 +79,51 @@ public:
         m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
     }
 
-    inline const std::vector<VertexBufferElement> GetElements() const&
+    template<>
+    void Push<short>(unsigned int count)
+    {
+        m_Elements.push_back({ count, GL_SHORT, GL_FALSE });
+        m_Stride += count * VertexBufferElement::GetSizeOfType(GL_SHORT);
+    }
+
+    template<>
+    void Push<Half>(unsigned int count)
+    {
+        m_Elements.push_back({ count, GL_HALF_FLOAT, GL_FALSE });
+        m_Stride += count * VertexBufferElement::GetSizeOfType(GL_HALF_FLOAT);
+    }
+
+    template<>
+    void Push<Snorm16>(unsigned int count)
+    {
+        m_Elements.push_back({ count, GL_SHORT, GL_TRUE });
+        m_Stride += count * VertexBufferElement::GetSizeOfType(GL_SHORT);
+    }
+
+    template<>
+    void Push<Unorm16>(unsigned int count)
+    {
+        m_Elements.push_back({ count, GL_UNSIGNED_SHORT, GL_TRUE });
+        m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_SHORT);
+    }
+
+    // 打包格式固定为 4 个分量，着色器中声明为 vec3 时 w 被忽略
+    template<>
+    void Push<Snorm1010102>(unsigned int count)
+    {
+        ASSERT(count == 4);
+        m_Elements.push_back({ 4, GL_INT_2_10_10_10_REV, GL_TRUE });
+        m_Stride += VertexBufferElement::GetSizeOfType(GL_INT_2_10_10_10_REV);
+    }
+
+    // 运行时决定格式时使用（如 VertexQuantizer 生成的布局）
+    void Push(unsigned int type, unsigned int count, bool normalized)
+    {
+        m_Elements.push_back({ count, type, (unsigned char)(normalized ? GL_TRUE : GL_FALSE) });
+        m_Stride += VertexBufferElement::GetSize(type, count);
+    }
+
+    inline const std::vector<VertexBufferElement>& GetElements() const
     {
         return m_Elements;
     }
@@ -67,4 +131,45 @@ public:
     {
         return m_Stride;
 	}
+    inline unsigned int GetInstanceDivisor() const
+    {
+        return m_Divisor;
+    }
+
+    // FNV-1a，依次混入每个元素的格式、步长和除数；VertexArrayCache 用它作为键
+    unsigned long long Hash() const
+    {
+        unsigned long long hash = 14695981039346656037ull;
+        auto mix = [&hash](unsigned int value)
+        {
+            for (int i = 0; i < 4; i++, value >>= 8)
+            {
+                hash ^= value & 0xFF;
+                hash *= 1099511628211ull;
+            }
+        };
+        for (const VertexBufferElement& element : m_Elements)
+        {
+            mix(element.count);
+            mix(element.type);
+            mix(element.normalized);
+        }
+        mix(m_Stride);
+        mix(m_Divisor);
+        return hash;
+    }
+
+    bool operator==(const VertexBufferLayout& other) const
+    {
+        if (m_Stride != other.m_Stride || m_Divisor != other.m_Divisor || m_Elements.size() != other.m_Elements.size())
+            return false;
+        for (size_t i = 0; i < m_Elements.size(); i++)
+        {
+            const VertexBufferElement& a = m_Elements[i];
+            const VertexBufferElement& b = other.m_Elements[i];
+            if (a.count != b.count || a.type != b.type || a.normalized != b.normalized)
+                return false;
+        }
+        return true;
+    }
 };
\ No newline at end of file
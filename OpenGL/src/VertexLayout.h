@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Renderer.h"
+#include "VertexTypes.h"
+
+// 编译期顶点布局：用顶点结构体和它的成员描述一次，步长、偏移、GL 类型和属性位置数都在编译期算出，
+// VertexArray::AddBuffer<Layout> 展开成一串 glVertexAttribPointer（DSA 路径为 glVertexArrayAttribFormat），
+// 不分配内存也不在运行时查表。
+//
+//     struct QuadVertex { float Position[3]; float Color[4]; };
+//     using QuadLayout = VertexLayout<QuadVertex,
+//         VERTEX_ATTRIBUTE(QuadVertex, Position),
+//         VERTEX_ATTRIBUTE(QuadVertex, Color)>;
+//     va.AddBuffer<QuadLayout>(vb);
+
+// C++ 类型到 GL 类型的映射，与 VertexBufferLayout::Push<T> 的约定一致
+template<typename T>
+struct VertexAttributeTraits
+{
+    static_assert(sizeof(T) == 0, "unsupported vertex attribute type");
+};
+
+#define VERTEX_ATTRIBUTE_TRAITS(T, glType, count, normalized) \
+    template<> \
+    struct VertexAttributeTraits<T> \
+    { \
+        static constexpr unsigned int Type = glType; \
+        static constexpr unsigned int Count = count; \
+        static constexpr unsigned char Normalized = normalized; \
+        static constexpr unsigned int ComponentSize = sizeof(T) / count; \
+    };
+
+VERTEX_ATTRIBUTE_TRAITS(float, GL_FLOAT, 1, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(int, GL_INT, 1, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(unsigned int, GL_UNSIGNED_INT, 1, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(short, GL_SHORT, 1, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(unsigned char, GL_UNSIGNED_BYTE, 1, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Half, GL_HALF_FLOAT, 1, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(Snorm16, GL_SHORT, 1, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Unorm16, GL_UNSIGNED_SHORT, 1, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Snorm1010102, GL_INT_2_10_10_10_REV, 4, GL_TRUE)
+
+#undef VERTEX_ATTRIBUTE_TRAITS
+
+// 数组成员：分量数相乘，类型不变
+template<typename T, size_t N>
+struct VertexAttributeTraits<T[N]>
+{
+    static constexpr unsigned int Type = VertexAttributeTraits<T>::Type;
+    static constexpr unsigned int Count = VertexAttributeTraits<T>::Count * (unsigned int)N;
+    static constexpr unsigned char Normalized = VertexAttributeTraits<T>::Normalized;
+    static constexpr unsigned int ComponentSize = VertexAttributeTraits<T>::ComponentSize;
+};
+
+template<typename T, unsigned int AttributeOffset>
+struct VertexAttribute
+{
+    using Traits = VertexAttributeTraits<T>;
+    static constexpr unsigned int Type = Traits::Type;
+    static constexpr unsigned int Count = Traits::Count;
+    static constexpr unsigned char Normalized = Traits::Normalized;
+    static constexpr unsigned int Offset = AttributeOffset;
+    static constexpr unsigned int Size = sizeof(T);
+    // 超过 4 个分量的属性（如 mat4）占用多个连续位置
+    static constexpr unsigned int Locations = (Count + 3) / 4;
+
+    static_assert(Type != GL_INT_2_10_10_10_REV || Locations == 1, "packed attributes cannot be arrays");
+
+    static void Apply(unsigned int& location, unsigned int stride, unsigned int divisor)
+    {
+        for (unsigned int i = 0; i < Locations; i++, location++)
+        {
+            unsigned int count = Count - i * 4 < 4 ? Count - i * 4 : 4;
+            GLCall(glEnableVertexAttribArray(location));
+            GLCall(glVertexAttribPointer(location, count, Type, Normalized, stride,
+                (const void*)(uintptr_t)(Offset + i * 4 * Traits::ComponentSize)));
+            if (divisor != 0)
+            {
+                GLCall(glVertexAttribDivisor(location, divisor));
+            }
+        }
+    }
+
+    // DSA 路径：只设置格式并关联到 binding，缓冲、步长和除数由绑定点提供
+    static void ApplyFormat(unsigned int vertexArray, unsigned int& location, unsigned int binding)
+    {
+        for (unsigned int i = 0; i < Locations; i++, location++)
+        {
+            unsigned int count = Count - i * 4 < 4 ? Count - i * 4 : 4;
+            GLCall(glEnableVertexArrayAttrib(vertexArray, location));
+            GLCall(glVertexArrayAttribFormat(vertexArray, location, count, Type, Normalized, Offset + i * 4 * Traits::ComponentSize));
+            GLCall(glVertexArrayAttribBinding(vertexArray, location, binding));
+        }
+    }
+};
+
+#define VERTEX_ATTRIBUTE(Vertex, Member) VertexAttribute<decltype(Vertex::Member), (unsigned int)offsetof(Vertex, Member)>
+
+template<typename Vertex, typename... Attributes>
+struct VertexLayout
+{
+    static constexpr unsigned int Stride = sizeof(Vertex);
+    static constexpr unsigned int AttributeCount = sizeof...(Attributes);
+    static constexpr unsigned int LocationCount = (0 + ... + Attributes::Locations);
+
+    static_assert(((Attributes::Offset + Attributes::Size <= Stride) && ...), "attribute lies outside the vertex");
+
+    // 从 firstLocation 开始依次设置所有属性，返回下一个可用的位置
+    static unsigned int Apply(unsigned int firstLocation, unsigned int divisor = 0)
+    {
+        unsigned int location = firstLocation;
+        (Attributes::Apply(location, Stride, divisor), ...);
+        return location;
+    }
+
+    static unsigned int ApplyFormat(unsigned int vertexArray, unsigned int firstLocation, unsigned int binding)
+    {
+        unsigned int location = firstLocation;
+        (Attributes::ApplyFormat(vertexArray, location, binding), ...);
+        return location;
+    }
+};
@@ -0,0 +1,297 @@
+#include "VertexQuantizer.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    const char* FormatName(VertexFormat format)
+    {
+        switch (format)
+        {
+        case VertexFormat::Float:        return "float";
+        case VertexFormat::Half:         return "half";
+        case VertexFormat::Snorm16:      return "snorm16";
+        case VertexFormat::Unorm16:      return "unorm16";
+        case VertexFormat::Unorm8:       return "unorm8";
+        case VertexFormat::Snorm1010102: return "snorm10_10_10_2";
+        }
+        return "?";
+    }
+
+    bool IsSigned(VertexFormat format)
+    {
+        return format == VertexFormat::Snorm16 || format == VertexFormat::Snorm1010102;
+    }
+}
+
+VertexQuantizer::VertexQuantizer() : m_Stride(0)
+{
+}
+
+void VertexQuantizer::AddAttribute(unsigned int count, VertexFormat format)
+{
+    ASSERT(count >= 1 && count <= 4);
+    ASSERT(format != VertexFormat::Snorm1010102 || count <= 4);
+    QuantizedAttribute attribute;
+    attribute.Format = format;
+    attribute.Count = count;
+    attribute.StoredCount = GetStoredCount(format, count);
+    attribute.MaxError = -1.0f;
+    m_Attributes.push_back(attribute);
+}
+
+void VertexQuantizer::AddAttribute(unsigned int count, float maxError)
+{
+    ASSERT(count >= 1 && count <= 4 && maxError >= 0.0f);
+    QuantizedAttribute attribute;
+    attribute.Count = count;
+    attribute.StoredCount = count;
+    attribute.MaxError = maxError;
+    m_Attributes.push_back(attribute);
+}
+
+unsigned int VertexQuantizer::GetStoredCount(VertexFormat format, unsigned int count)
+{
+    // 每个属性都补齐到 4 字节，避免顶点获取时的非对齐访问
+    switch (format)
+    {
+    case VertexFormat::Float:        return count;
+    case VertexFormat::Half:
+    case VertexFormat::Snorm16:
+    case VertexFormat::Unorm16:      return (count + 1) & ~1u;
+    case VertexFormat::Unorm8:       return (count + 3) & ~3u;
+    case VertexFormat::Snorm1010102: return 4;
+    }
+    return count;
+}
+
+unsigned int VertexQuantizer::GetSize(VertexFormat format, unsigned int count)
+{
+    unsigned int stored = GetStoredCount(format, count);
+    switch (format)
+    {
+    case VertexFormat::Float:        return stored * 4;
+    case VertexFormat::Half:
+    case VertexFormat::Snorm16:
+    case VertexFormat::Unorm16:      return stored * 2;
+    case VertexFormat::Unorm8:       return stored;
+    case VertexFormat::Snorm1010102: return 4;
+    }
+    return stored * 4;
+}
+
+float VertexQuantizer::Encode(QuantizedAttribute& attribute, const float* vertices, unsigned int sourceStride, unsigned int sourceOffset,
+    unsigned int vertexCount, unsigned char* output, unsigned int stride, unsigned int offset)
+{
+    VertexFormat format = attribute.Format;
+    unsigned int count = attribute.Count;
+
+    // 超出格式本身范围的分量按包围盒重映射
+    for (unsigned int c = 0; c < 4; c++)
+    {
+        attribute.Scale[c] = 1.0f;
+        attribute.Offset[c] = 0.0f;
+    }
+    if (format != VertexFormat::Float && format != VertexFormat::Half)
+    {
+        float low = IsSigned(format) ? -1.0f : 0.0f;
+        for (unsigned int c = 0; c < count; c++)
+        {
+            float minValue = vertexCount ? vertices[sourceOffset + c] : 0.0f;
+            float maxValue = minValue;
+            for (unsigned int v = 0; v < vertexCount; v++)
+            {
+                float value = vertices[(size_t)v * sourceStride + sourceOffset + c];
+                minValue = value < minValue ? value : minValue;
+                maxValue = value > maxValue ? value : maxValue;
+            }
+            if (minValue >= low && maxValue <= 1.0f)
+                continue;
+            if (IsSigned(format))
+            {
+                attribute.Offset[c] = (minValue + maxValue) * 0.5f;
+                attribute.Scale[c] = (maxValue - minValue) * 0.5f;
+            }
+            else
+            {
+                attribute.Offset[c] = minValue;
+                attribute.Scale[c] = maxValue - minValue;
+            }
+            if (attribute.Scale[c] == 0.0f)
+                attribute.Scale[c] = 1.0f;
+        }
+    }
+
+    float maxError = 0.0f;
+    for (unsigned int v = 0; v < vertexCount; v++)
+    {
+        const float* source = &vertices[(size_t)v * sourceStride + sourceOffset];
+        unsigned char* target = output + (size_t)v * stride + offset;
+        // 补齐的分量按 GL 的默认值写入（y、z 为 0，w 为 1），着色器按 vec4 读取时 w 仍为 1
+        float normalized[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float decoded[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (unsigned int c = 0; c < count; c++)
+            normalized[c] = (source[c] - attribute.Offset[c]) / attribute.Scale[c];
+
+        switch (format)
+        {
+        case VertexFormat::Float:
+            std::memcpy(target, source, count * sizeof(float));
+            std::memcpy(decoded, source, count * sizeof(float));
+            break;
+        case VertexFormat::Half:
+        {
+            unsigned short values[4] = {};
+            for (unsigned int c = 0; c < attribute.StoredCount; c++)
+            {
+                values[c] = FloatToHalf(normalized[c]);
+                decoded[c] = HalfToFloat(values[c]);
+            }
+            std::memcpy(target, values, attribute.StoredCount * sizeof(unsigned short));
+            break;
+        }
+        case VertexFormat::Snorm16:
+        {
+            short values[4] = {};
+            for (unsigned int c = 0; c < attribute.StoredCount; c++)
+            {
+                values[c] = FloatToSnorm16(normalized[c]);
+                decoded[c] = Snorm16ToFloat(values[c]);
+            }
+            std::memcpy(target, values, attribute.StoredCount * sizeof(short));
+            break;
+        }
+        case VertexFormat::Unorm16:
+        {
+            unsigned short values[4] = {};
+            for (unsigned int c = 0; c < attribute.StoredCount; c++)
+            {
+                values[c] = FloatToUnorm16(normalized[c]);
+                decoded[c] = Unorm16ToFloat(values[c]);
+            }
+            std::memcpy(target, values, attribute.StoredCount * sizeof(unsigned short));
+            break;
+        }
+        case VertexFormat::Unorm8:
+        {
+            unsigned char values[4] = {};
+            for (unsigned int c = 0; c < attribute.StoredCount; c++)
+            {
+                values[c] = FloatToUnorm8(normalized[c]);
+                decoded[c] = Unorm8ToFloat(values[c]);
+            }
+            std::memcpy(target, values, attribute.StoredCount);
+            break;
+        }
+        case VertexFormat::Snorm1010102:
+        {
+            unsigned int bits = PackSnorm1010102(normalized[0], normalized[1], normalized[2], normalized[3]);
+            UnpackSnorm1010102(bits, decoded);
+            std::memcpy(target, &bits, sizeof(bits));
+            break;
+        }
+        }
+
+        for (unsigned int c = 0; c < count; c++)
+        {
+            if (format != VertexFormat::Float && format != VertexFormat::Half)
+                decoded[c] = decoded[c] * attribute.Scale[c] + attribute.Offset[c];
+            float error = std::fabs(decoded[c] - source[c]);
+            if (std::isnan(error))
+                error = INFINITY;
+            maxError = error > maxError ? error : maxError;
+        }
+    }
+    return maxError;
+}
+
+unsigned int VertexQuantizer::Quantize(const float* vertices, unsigned int vertexCount, std::vector<unsigned char>& output)
+{
+    unsigned int sourceStride = 0;
+    for (const QuantizedAttribute& attribute : m_Attributes)
+        sourceStride += attribute.Count;
+
+    // 为指定了误差上限的属性选择格式：先比较字节数，字节数相同时选误差更小的
+    std::vector<unsigned char> scratch;
+    unsigned int sourceOffset = 0;
+    for (QuantizedAttribute& attribute : m_Attributes)
+    {
+        if (attribute.MaxError >= 0.0f)
+        {
+            static const VertexFormat candidates[] = {
+                VertexFormat::Snorm1010102, VertexFormat::Unorm8, VertexFormat::Snorm16, VertexFormat::Unorm16,
+                VertexFormat::Half, VertexFormat::Float
+            };
+            QuantizedAttribute best;
+            bool found = false;
+            for (VertexFormat format : candidates)
+            {
+                if (format == VertexFormat::Snorm1010102 && attribute.Count > 3)
+                    continue;
+                QuantizedAttribute candidate = attribute;
+                candidate.Format = format;
+                candidate.StoredCount = GetStoredCount(format, attribute.Count);
+                unsigned int size = GetSize(format, attribute.Count);
+                scratch.resize((size_t)vertexCount * size);
+                candidate.ActualError = Encode(candidate, vertices, sourceStride, sourceOffset, vertexCount, scratch.data(), size, 0);
+                if (candidate.ActualError > attribute.MaxError)
+                    continue;
+                unsigned int bestSize = found ? GetSize(best.Format, best.Count) : 0;
+                if (!found || size < bestSize || (size == bestSize && candidate.ActualError < best.ActualError))
+                {
+                    best = candidate;
+                    found = true;
+                }
+            }
+            // float 的误差为 0，一定满足
+            ASSERT(found);
+            attribute = best;
+        }
+        sourceOffset += attribute.Count;
+    }
+
+    m_Stride = 0;
+    for (const QuantizedAttribute& attribute : m_Attributes)
+        m_Stride += GetSize(attribute.Format, attribute.Count);
+
+    output.assign((size_t)vertexCount * m_Stride, 0);
+    unsigned int offset = 0;
+    sourceOffset = 0;
+    for (QuantizedAttribute& attribute : m_Attributes)
+    {
+        attribute.ActualError = Encode(attribute, vertices, sourceStride, sourceOffset, vertexCount, output.data(), m_Stride, offset);
+        offset += GetSize(attribute.Format, attribute.Count);
+        sourceOffset += attribute.Count;
+    }
+    return m_Stride;
+}
+
+VertexBufferLayout VertexQuantizer::GetLayout() const
+{
+    VertexBufferLayout layout;
+    for (const QuantizedAttribute& attribute : m_Attributes)
+    {
+        switch (attribute.Format)
+        {
+        case VertexFormat::Float:        layout.Push(GL_FLOAT, attribute.StoredCount, false); break;
+        case VertexFormat::Half:         layout.Push(GL_HALF_FLOAT, attribute.StoredCount, false); break;
+        case VertexFormat::Snorm16:      layout.Push(GL_SHORT, attribute.StoredCount, true); break;
+        case VertexFormat::Unorm16:      layout.Push(GL_UNSIGNED_SHORT, attribute.StoredCount, true); break;
+        case VertexFormat::Unorm8:       layout.Push(GL_UNSIGNED_BYTE, attribute.StoredCount, true); break;
+        case VertexFormat::Snorm1010102: layout.Push(GL_INT_2_10_10_10_REV, 4, true); break;
+        }
+    }
+    return layout;
+}
+
+void VertexQuantizer::PrintSummary(unsigned int sourceStride) const
+{
+    std::cout << "[VertexQuantizer] stride " << sourceStride << " -> " << m_Stride << " bytes:";
+    for (const QuantizedAttribute& attribute : m_Attributes)
+    {
+        std::cout << " " << FormatName(attribute.Format) << "x" << attribute.Count
+            << " (err " << attribute.ActualError << (attribute.NeedsDecode() ? ", decode" : "") << ")";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include "VertexBufferLayout.h"
+
+enum class VertexFormat
+{
+    Float,
+    Half,
+    Snorm16,
+    Unorm16,
+    Unorm8,
+    Snorm1010102
+};
+
+// 一个属性量化后的结果。归一化格式的数据超出 [-1, 1]（Unorm 为 [0, 1]）时按包围盒重映射，
+// 着色器中用 value * Scale + Offset 还原；不需要还原时 Scale 为 1、Offset 为 0
+struct QuantizedAttribute
+{
+    VertexFormat Format = VertexFormat::Float;
+    unsigned int Count = 0;       // 源数据中的分量数
+    unsigned int StoredCount = 0; // 写入缓冲的分量数，为保证 4 字节对齐可能多于 Count，多出的 y、z 为 0，w 为 1
+    float MaxError = 0.0f;        // 允许的最大绝对误差，小于 0 表示使用固定格式
+    float ActualError = 0.0f;     // 量化后实际的最大绝对误差
+    float Scale[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float Offset[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    inline bool NeedsDecode() const
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (Scale[i] != 1.0f || Offset[i] != 0.0f)
+                return true;
+        }
+        return false;
+    }
+};
+
+// 把 float 顶点数据转换为紧凑格式。每个源顶点依次包含所有属性的 float 分量。
+// 指定误差上限的属性会依次尝试更小的格式，选出第一个实际误差不超过上限的
+class VertexQuantizer
+{
+private:
+    std::vector<QuantizedAttribute> m_Attributes;
+    unsigned int m_Stride;
+public:
+    VertexQuantizer();
+
+    void AddAttribute(unsigned int count, VertexFormat format);
+    void AddAttribute(unsigned int count, float maxError);
+
+    // 返回输出的顶点步长（字节）
+    unsigned int Quantize(const float* vertices, unsigned int vertexCount, std::vector<unsigned char>& output);
+
+    // Quantize 之后有效
+    VertexBufferLayout GetLayout() const;
+    inline const std::vector<QuantizedAttribute>& GetAttributes() const { return m_Attributes; }
+    inline unsigned int GetStride() const { return m_Stride; }
+    void PrintSummary(unsigned int sourceStride) const;
+
+    static unsigned int GetStoredCount(VertexFormat format, unsigned int count);
+    static unsigned int GetSize(VertexFormat format, unsigned int count);
+private:
+    // 计算 Scale/Offset，写入 output（步长 stride，起始偏移 offset）并返回实际最大误差
+    static float Encode(QuantizedAttribute& attribute, const float* vertices, unsigned int sourceStride, unsigned int sourceOffset,
+        unsigned int vertexCount, unsigned char* output, unsigned int stride, unsigned int offset);
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+// 紧凑顶点格式的标记类型，用于 VertexBufferLayout::Push<T>，以及与 float 之间的转换
+
+struct Half           // GL_HALF_FLOAT
+{
+    unsigned short Bits;
+};
+
+struct Snorm16        // GL_SHORT，归一化到 [-1, 1]
+{
+    short Value;
+};
+
+struct Unorm16        // GL_UNSIGNED_SHORT，归一化到 [0, 1]
+{
+    unsigned short Value;
+};
+
+struct Snorm1010102   // GL_INT_2_10_10_10_REV，归一化，x/y/z 各 10 位，w 2 位
+{
+    unsigned int Bits;
+};
+
+// 就近舍入到偶数，溢出变为无穷大，过小的值变为非规格化数或 0
+inline unsigned short FloatToHalf(float value)
+{
+    unsigned int bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    unsigned int sign = (bits >> 16) & 0x8000;
+    unsigned int rawExponent = (bits >> 23) & 0xFF;
+    unsigned int mantissa = bits & 0x7FFFFF;
+    int exponent = (int)rawExponent - 127 + 15;
+
+    if (rawExponent == 0xFF)
+        return (unsigned short)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    if (exponent >= 31)
+        return (unsigned short)(sign | 0x7C00);
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+            return (unsigned short)sign;
+        mantissa |= 0x800000;
+        unsigned int shift = (unsigned int)(14 - exponent);
+        unsigned int half = mantissa >> shift;
+        unsigned int rest = mantissa & ((1u << shift) - 1);
+        unsigned int middle = 1u << (shift - 1);
+        if (rest > middle || (rest == middle && (half & 1)))
+            half++;
+        return (unsigned short)(sign | half);
+    }
+
+    unsigned int half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+    unsigned int rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++; // 进位到指数也是正确的结果
+    return (unsigned short)(sign | half);
+}
+
+inline float HalfToFloat(unsigned short half)
+{
+    unsigned int sign = (unsigned int)(half & 0x8000) << 16;
+    unsigned int exponent = (half >> 10) & 0x1F;
+    unsigned int mantissa = half & 0x3FF;
+    unsigned int bits;
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // 非规格化数：移到最高位为 1 后按规格化数表示
+            int e = 1;
+            while (!(mantissa & 0x400))
+            {
+                mantissa <<= 1;
+                e--;
+            }
+            bits = sign | ((unsigned int)(e + 112) << 23) | ((mantissa & 0x3FF) << 13);
+        }
+    }
+    else if (exponent == 31)
+    {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline short FloatToSnorm16(float value)
+{
+    value = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+    return (short)std::lround(value * 32767.0f);
+}
+
+inline float Snorm16ToFloat(short value)
+{
+    float f = value / 32767.0f;
+    return f < -1.0f ? -1.0f : f;
+}
+
+inline unsigned short FloatToUnorm16(float value)
+{
+    value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+    return (unsigned short)std::lround(value * 65535.0f);
+}
+
+inline float Unorm16ToFloat(unsigned short value)
+{
+    return value / 65535.0f;
+}
+
+inline unsigned char FloatToUnorm8(float value)
+{
+    value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+    return (unsigned char)std::lround(value * 255.0f);
+}
+
+inline float Unorm8ToFloat(unsigned char value)
+{
+    return value / 255.0f;
+}
+
+inline unsigned int PackSnorm1010102(float x, float y, float z, float w = 0.0f)
+{
+    auto pack = [](float value, float scale, unsigned int mask)
+    {
+        value = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+        return (unsigned int)(int)std::lround(value * scale) & mask;
+    };
+    return pack(x, 511.0f, 0x3FF) | (pack(y, 511.0f, 0x3FF) << 10) | (pack(z, 511.0f, 0x3FF) << 20) | (pack(w, 1.0f, 0x3) << 30);
+}
+
+// 按 GL 4.2 之后的规则解码：max(q / (2^(b-1) - 1), -1)
+inline void UnpackSnorm1010102(unsigned int bits, float out[4])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        int q = (int)((bits >> (10 * i)) & 0x3FF);
+        if (q & 0x200)
+            q -= 0x400;
+        float f = q / 511.0f;
+        out[i] = f < -1.0f ? -1.0f : f;
+    }
+    int w = (int)(bits >> 30);
+    if (w & 0x2)
+        w -= 0x4;
+    out[3] = w < -1 ? -1.0f : (float)w;
+}
@@ -0,0 +1,85 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+    : m_Task(nullptr), m_Context(nullptr), m_Count(0), m_Next(0), m_Active(0), m_Generation(0), m_Stop(false)
+{
+    m_Threads.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++)
+        m_Threads.emplace_back([this]() { WorkerLoop(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_WorkReady.notify_all();
+    for (std::thread& thread : m_Threads)
+        thread.join();
+}
+
+void WorkerPool::Run(unsigned int count, TaskFn task, void* context)
+{
+    if (count == 0)
+        return;
+    // 只有一项或者没有工作线程时不必唤醒任何线程
+    if (count == 1 || m_Threads.empty())
+    {
+        for (unsigned int i = 0; i < count; i++)
+            task(context, i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Task = task;
+        m_Context = context;
+        m_Count = count;
+        m_Next.store(0, std::memory_order_relaxed);
+        m_Active = (unsigned int)m_Threads.size();
+        m_Generation++;
+    }
+    m_WorkReady.notify_all();
+    Drain();
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_WorkDone.wait(lock, [this]() { return m_Active == 0; });
+    m_Task = nullptr;
+    m_Context = nullptr;
+}
+
+void WorkerPool::WorkerLoop()
+{
+    unsigned long long seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkReady.wait(lock, [this, seen]() { return m_Stop || m_Generation != seen; });
+            if (m_Stop)
+                return;
+            seen = m_Generation;
+        }
+        Drain();
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (--m_Active == 0)
+                m_WorkDone.notify_one();
+        }
+    }
+}
+
+void WorkerPool::Drain()
+{
+    // m_Task 等字段在加锁时写入，工作线程加锁读到新的代数之后才会访问，不需要再加锁
+    unsigned int index;
+    while ((index = m_Next.fetch_add(1, std::memory_order_relaxed)) < m_Count)
+        m_Task(m_Context, index);
+}
+
+WorkerPool& WorkerPool::Get()
+{
+    static WorkerPool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    return pool;
+}
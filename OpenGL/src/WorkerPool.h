@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 常驻的工作线程池：线程只在构造时创建一次，每次 Run 只是唤醒它们。
+// 任务按下标从共享计数器领取，调用线程也参与执行，全部完成后 Run 才返回。
+// Run 不可重入，也不能从多个线程同时调用
+class WorkerPool
+{
+private:
+    using TaskFn = void(*)(void* context, unsigned int index);
+
+    std::vector<std::thread> m_Threads;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkReady;
+    std::condition_variable m_WorkDone;
+    TaskFn m_Task;
+    void* m_Context;
+    unsigned int m_Count;
+    std::atomic<unsigned int> m_Next;
+    unsigned int m_Active;               // 还在处理本轮任务的工作线程数
+    unsigned long long m_Generation;     // 每次 Run 加一，工作线程据此发现新任务
+    bool m_Stop;
+public:
+    explicit WorkerPool(unsigned int threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // 对 [0, count) 中的每个下标调用一次 task(index)
+    template<typename Fn>
+    void Run(unsigned int count, Fn& task)
+    {
+        Run(count, [](void* context, unsigned int index) { (*(Fn*)context)(index); }, &task);
+    }
+    void Run(unsigned int count, TaskFn task, void* context);
+
+    inline unsigned int GetThreadCount() const { return (unsigned int)m_Threads.size(); }
+
+    // 按硬件线程数减一（调用线程自己算一个）在第一次使用时创建
+    static WorkerPool& Get();
+private:
+    void WorkerLoop();
+    void Drain();
+};
@@ -1,3 +1,21 @@
+-- GLCall 错误检查级别：premake5 vs2022 --glcheck=deferred
+newoption {
+    trigger = "glcheck",
+    value = "LEVEL",
+    description = "GLCall 错误检查级别（默认 Debug 为 full，Release 为 off）",
+    allowed = {
+        { "off",      "GLCall 直接展开为 GL 调用" },
+        { "deferred", "每帧检查一次 glGetError" },
+        { "full",     "每次调用都检查 glGetError" }
+    }
+}
+
+-- 录制 GL 调用：premake5 vs2022 --gltrace，运行时加 --trace <文件>
+newoption {
+    trigger = "gltrace",
+    description = "编译 GL 调用录制器（GL_TRACE）"
+}
+
 workspace "OpenGL"
     configurations { "Debug", "Release" }
     architecture "x86"
@@ -36,6 +54,13 @@ project "OpenGL"
         "glew32s" -- 静态链接 GLEW
     }
 
+    if _OPTIONS["glcheck"] then
+        defines { "GL_CHECK_LEVEL=GL_CHECK_" .. string.upper(_OPTIONS["glcheck"]) }
+    end
+
+    filter "options:gltrace"
+        defines { "GL_TRACE" }
+
     -- Windows 配置
     filter "system:windows"
         systemversion "latest"
@@ -50,3 +75,49 @@ project "OpenGL"
     filter "configurations:Release"
         defines { "NDEBUG" }
         optimize "On"
+
+-- 无窗口回放 GL 调用追踪并统计 CPU 开销（配合 --gltrace 录制的文件使用）
+project "GLReplay"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    staticruntime "off"
+
+    targetdir ("bin/%{cfg.buildcfg}")
+    objdir ("bin-int/%{cfg.buildcfg}/GLReplay")
+
+    files {
+        "GLReplay/src/**.h",
+        "GLReplay/src/**.cpp",
+        "OpenGL/src/GLTraceFormat.h" -- 与录制端共用的文件格式
+    }
+
+    includedirs {
+        "GLReplay/src",
+        "OpenGL/src",
+        "Dependencies/GLFW/include",
+        "Dependencies/GLEW/include"
+    }
+
+    libdirs {
+        "Dependencies/GLFW/lib-vc2022",
+        "Dependencies/GLEW/lib/Release/Win32"
+    }
+
+    -- Windows 配置（软件渲染时把 Mesa 的 opengl32.dll 放到 bin 目录）
+    filter "system:windows"
+        systemversion "latest"
+        defines { "PLATFORM_WINDOWS", "GLEW_STATIC" }
+        links { "glfw3", "opengl32", "glew32s" }
+
+    -- Linux 渲染节点（Mesa llvmpipe），无显示服务器时通过 EGL 创建上下文
+    filter "system:linux"
+        links { "glfw", "GLEW", "GL", "EGL", "pthread" }
+
+    filter "configurations:Debug"
+        defines { "DEBUG" }
+        symbols "On"
+
+    filter "configurations:Release"
+        defines { "NDEBUG" }
+        optimize "On"